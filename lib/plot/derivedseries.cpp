@@ -0,0 +1,277 @@
+#include "derivedseries.h"
+#include "seriesstore.h"
+#include <QtConcurrent>
+#include <QtMath>
+#include <complex>
+#include <cmath>
+
+namespace
+{
+
+const int blockSize = 1 << 16;
+
+// Начала блоков по blockSize точек
+QVector<int> blocks(int size)
+{
+	QVector<int> result;
+	for(int i = 0; i < size; i += blockSize)
+		result << i;
+
+	return result;
+}
+
+}
+
+QVector<QPointF> DerivedSeries::compute(Operation operation, const QVector<QPointF> &series)
+{
+	switch( operation ) {
+	case Derivative:
+		return derivative(series);
+	case Integral:
+		return integral(series);
+	case MovingAverage:
+		// Окно - сотая часть ряда
+		return movingAverage(series, qMax(1, series.size() / 100));
+	case Spectrum:
+		return spectrum(series);
+	default:
+		return QVector<QPointF>();
+	}
+}
+
+QVector<QPointF> DerivedSeries::derivative(const QVector<QPointF> &series)
+{
+	const int size = series.size();
+	QVector<QPointF> result(size);
+
+	if( size < 2 )
+		return QVector<QPointF>();
+
+	const QPointF *s = series.constData();
+	QPointF *r = result.data();
+	QVector<int> starts = blocks(size);
+
+	QtConcurrent::blockingMap(starts, [=](int begin)
+	{
+		const int end = qMin(begin + blockSize, size);
+		for(int i = begin; i < end; ++i) {
+			// На краях - односторонние разности
+			const int prev = qMax(0, i - 1);
+			const int next = qMin(size - 1, i + 1);
+			r[i] = QPointF(s[i].x(), (s[next].y() - s[prev].y()) / (s[next].x() - s[prev].x()));
+		}
+	});
+
+	return result;
+}
+
+QVector<QPointF> DerivedSeries::integral(const QVector<QPointF> &series)
+{
+	const int size = series.size();
+	QVector<QPointF> result(size);
+
+	if( size == 0 )
+		return result;
+
+	const QPointF *s = series.constData();
+	QPointF *r = result.data();
+	QVector<int> starts = blocks(size);
+
+	// Параллельная префиксная сумма: локальные суммы блоков,
+	// затем последовательно смещения, затем параллельно их добавление
+	QtConcurrent::blockingMap(starts, [=](int begin)
+	{
+		const int end = qMin(begin + blockSize, size);
+		double sum = 0;
+
+		for(int i = begin; i < end; ++i) {
+			if( i > 0 )
+				sum += 0.5 * (s[i].y() + s[i - 1].y()) * (s[i].x() - s[i - 1].x());
+			r[i] = QPointF(s[i].x(), sum);
+		}
+	});
+
+	QVector<double> offsets(starts.size(), 0.0);
+	for(int b = 1; b < starts.size(); ++b)
+		offsets[b] = offsets[b - 1] + r[starts[b] - 1].y();
+
+	QVector<int> indexes;
+	for(int b = 1; b < starts.size(); ++b)
+		indexes << b;
+
+	QtConcurrent::blockingMap(indexes, [=](int b)
+	{
+		const int end = qMin(starts[b] + blockSize, size);
+		for(int i = starts[b]; i < end; ++i)
+			r[i].ry() += offsets[b];
+	});
+
+	return result;
+}
+
+QVector<QPointF> DerivedSeries::movingAverage(const QVector<QPointF> &series, int window)
+{
+	const int size = series.size();
+	const int half = qMax(0, window / 2);
+	QVector<QPointF> result(size);
+
+	const QPointF *s = series.constData();
+	QPointF *r = result.data();
+	QVector<int> starts = blocks(size);
+
+	QtConcurrent::blockingMap(starts, [=](int begin)
+	{
+		const int end = qMin(begin + blockSize, size);
+		// Каждый блок сам набирает начальное окно
+		double sum = 0;
+		int lo = qMax(0, begin - half), hi = qMin(size - 1, begin + half);
+
+		for(int j = lo; j <= hi; ++j)
+			sum += s[j].y();
+
+		for(int i = begin; i < end; ++i) {
+			r[i] = QPointF(s[i].x(), sum / (hi - lo + 1));
+
+			// Сдвиг окна на одну точку
+			if( i + 1 + half < size )
+				sum += s[++hi].y();
+			if( i - half >= 0 )
+				sum -= s[lo++].y();
+		}
+	});
+
+	return result;
+}
+
+QVector<QPointF> DerivedSeries::spectrum(const QVector<QPointF> &series)
+{
+	const int size = series.size();
+
+	if( size < 2 || size > spectrumLimit )
+		return QVector<QPointF>();
+
+	// Длина дополнения, в 64 битах сдвиг не переполняется
+	qint64 length = 1;
+	while( length < size )
+		length <<= 1;
+
+	const int n = static_cast<int>( length );
+
+	// Дополнение нулями до степени двойки, порядок бит обратный
+	QVector<std::complex<double>> data(n);
+	int bits = 0;
+	while( (1 << bits) < n )
+		++bits;
+
+	for(int i = 0; i < size; ++i) {
+		int j = 0;
+		for(int b = 0; b < bits; ++b)
+			j |= ((i >> b) & 1) << (bits - 1 - b);
+		data[j] = series[i].y();
+	}
+
+	std::complex<double> *d = data.data();
+
+	// Итеративный БПФ по основанию 2; группы бабочек
+	// одного уровня независимы и считаются параллельно
+	for(int len = 2; len <= n; len <<= 1) {
+		const double angle = -2 * M_PI / len;
+		const int groups = n / len;
+
+		QVector<int> starts;
+		const int groupsPerTask = qMax(1, blockSize / len);
+		for(int g = 0; g < groups; g += groupsPerTask)
+			starts << g;
+
+		QtConcurrent::blockingMap(starts, [=](int first)
+		{
+			const int last = qMin(groups, first + groupsPerTask);
+			for(int g = first; g < last; ++g) {
+				std::complex<double> *block = d + g * len;
+				for(int k = 0; k < len / 2; ++k) {
+					const std::complex<double> w = std::polar(1.0, angle * k);
+					const std::complex<double> u = block[k];
+					const std::complex<double> v = block[k + len / 2] * w;
+					block[k] = u + v;
+					block[k + len / 2] = u - v;
+				}
+			}
+		});
+	}
+
+	// Частоты до Найквиста при шаге исходной сетки
+	const double dx = (series.last().x() - series.first().x()) / (size - 1);
+	QVector<QPointF> result(n / 2 + 1);
+
+	for(int k = 0; k <= n / 2; ++k)
+		result[k] = QPointF(k / (n * dx), std::abs(data[k]) / size);
+
+	return result;
+}
+
+/* Stream */
+
+DerivedSeries::Stream::Stream(Operation operation, const SeriesStore &store, int buckets)
+	: m_operation(operation)
+	, m_size(store.size())
+	, m_decimator(store.first().x(), store.last().x(), buckets)
+{
+	// Окно - сотая часть ряда, как в compute()
+	if( m_operation == MovingAverage )
+		m_half = qMax(Q_INT64_C(1), m_size / 100) / 2;
+}
+
+bool DerivedSeries::Stream::isStreamable(Operation operation)
+{
+	return operation == Derivative || operation == Integral || operation == MovingAverage;
+}
+
+void DerivedSeries::Stream::add(const SeriesStore &store, qint64 begin, qint64 end)
+{
+	for(qint64 i = begin; i < end; ++i) {
+		const QPointF p = pointAt(store, i);
+		m_decimator.add(&p, 1);
+	}
+}
+
+QVector<QPointF> DerivedSeries::Stream::finish()
+{
+	return m_decimator.finish();
+}
+
+QPointF DerivedSeries::Stream::pointAt(const SeriesStore &s, qint64 i)
+{
+	switch( m_operation ) {
+	case Derivative: {
+		// Хранилище читается по индексу, соседи берутся и из других блоков
+		const qint64 prev = qMax(Q_INT64_C(0), i - 1);
+		const qint64 next = qMin(m_size - 1, i + 1);
+		return QPointF(s.at(i).x(), (s.at(next).y() - s.at(prev).y()) / (s.at(next).x() - s.at(prev).x()));
+	}
+	case Integral:
+		if( i > 0 )
+			m_sum += 0.5 * (s.at(i).y() + s.at(i - 1).y()) * (s.at(i).x() - s.at(i - 1).x());
+		return QPointF(s.at(i).x(), m_sum);
+	case MovingAverage: {
+		// Начальное окно набирается один раз, дальше сдвигается на точку
+		if( i == 0 ) {
+			m_lo = 0;
+			m_hi = qMin(m_size - 1, m_half);
+			m_sum = 0;
+			for(qint64 j = m_lo; j <= m_hi; ++j)
+				m_sum += s.at(j).y();
+		}
+
+		const QPointF result(s.at(i).x(), m_sum / (m_hi - m_lo + 1));
+
+		if( i + 1 + m_half < m_size )
+			m_sum += s.at(++m_hi).y();
+		if( i - m_half >= 0 )
+			m_sum -= s.at(m_lo++).y();
+
+		return result;
+	}
+	default:
+		return QPointF();
+	}
+}
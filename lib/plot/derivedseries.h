@@ -0,0 +1,61 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include "plotexport.h"
+#include <QVector>
+#include <QPointF>
+
+class SeriesStore;
+
+/* Ряды, производные от рассчитанного. Вычисляются блоками
+ * в общем пуле потоков (QThreadPool::globalInstance()) */
+namespace DerivedSeries
+{
+	enum Operation
+	{
+		None,
+		Derivative,		// Центральные разности
+		Integral,		// Накопленная сумма трапеций
+		MovingAverage,	// Скользящее среднее по window точкам
+		Spectrum		// Модуль БПФ, ось x - частота
+	};
+
+	PLOTENGINE_EXPORT QVector<QPointF> compute(Operation, const QVector<QPointF> &);
+
+	PLOTENGINE_EXPORT QVector<QPointF> derivative(const QVector<QPointF> &);
+	PLOTENGINE_EXPORT QVector<QPointF> integral(const QVector<QPointF> &);
+	PLOTENGINE_EXPORT QVector<QPointF> movingAverage(const QVector<QPointF> &, int window);
+	// Пуст для ряда длиннее spectrumLimit точек
+	PLOTENGINE_EXPORT QVector<QPointF> spectrum(const QVector<QPointF> &);
+
+	// БПФ считается в ОЗУ целиком, длина ряда для спектра ограничена
+	const int spectrumLimit = 1 << 24;
+
+	/* Потоковый расчет по хранилищу ряда: точки считаются порциями
+	 * по порядку и сразу прореживаются до buckets столбцов (см.
+	 * PlotExport::Decimator), в памяти остается только результат.
+	 * Спектру нужен ряд целиком, потоком он не считается */
+	class PLOTENGINE_EXPORT Stream
+	{
+	public:
+		// store - не менее двух точек, тот же ряд подается в add()
+		Stream(Operation, const SeriesStore &, int buckets);
+
+		static bool isStreamable(Operation);
+
+		// Точки [begin, end), порции идут подряд от начала ряда
+		void add(const SeriesStore &, qint64 begin, qint64 end);
+		QVector<QPointF> finish();
+
+	private:
+		QPointF pointAt(const SeriesStore &, qint64 i);
+
+	private:
+		Operation m_operation;
+		qint64 m_size;
+		qint64 m_half = 0;			// Полуокно скользящего среднего
+		qint64 m_lo = 0, m_hi = -1;	// Текущее окно
+		double m_sum = 0;			// Сумма окна или накопленный интеграл
+		PlotExport::Decimator m_decimator;
+	};
+}
@@ -0,0 +1,102 @@
+#include "functions.h"
+#include <cmath>
+
+QStringList PlotFunctions::names()
+{
+	return { "A*(x*x) + B*x + C", "A*sin(x) + B*cos(C*x)",
+			 "A*log(B*x)", "A / ( B*sin(x*x) )" };
+}
+
+int PlotFunctions::count()
+{
+	return names().size();
+}
+
+std::function<double(double)> PlotFunctions::make(int index, double A, double B, double C)
+{
+	switch( index ) {
+	case 0:
+		return Quadratic{A, B, C};
+	case 1:
+		return Harmonic{A, B, C};
+	case 2:
+		return Logarithm{A, B};
+	case 3:
+		return InverseSine{A, B};
+	default:
+		Q_UNREACHABLE();
+	}
+	return {};
+}
+
+PlotFunctions::Batch PlotFunctions::makeBatch(int index, double A, double B, double C)
+{
+	switch( index ) {
+	case 0:
+		return batch(Quadratic{A, B, C});
+	case 1:
+		return batch(Harmonic{A, B, C});
+	case 2:
+		return batch(Logarithm{A, B});
+	case 3:
+		return batch(InverseSine{A, B});
+	default:
+		Q_UNREACHABLE();
+	}
+	return {};
+}
+
+std::function<long double(long double)> PlotFunctions::makeExtended(int index, double A, double B, double C)
+{
+	const long double a = A, b = B, c = C;
+
+	switch( index ) {
+	case 0:
+		return [a, b, c](long double x){ return a*(x*x) + b*x + c; };
+	case 1:
+		return [a, b, c](long double x){ return a*std::sin(x) + b*std::cos(c*x); };
+	case 2:
+		return [a, b](long double x){ return a*std::log(b*x); };
+	case 3:
+		return [a, b](long double x){ return a / ( b*std::sin(x*x) ); };
+	default:
+		Q_UNREACHABLE();
+	}
+	return {};
+}
+
+PlotFunctions::Kernel PlotFunctions::kernel(int index)
+{
+	Kernel k;
+
+	switch( index ) {
+	case 0:
+		k.basisSize = 1;
+		k.basis = [](double x, double *b){ b[0] = x*x; };
+		k.combine = [](double x, const double *b, double A, double B, double C){ return A*b[0] + B*x + C; };
+		break;
+	case 1:
+		k.basisSize = 1;
+		k.basis = [](double x, double *b){ b[0] = sin(x); };
+		k.combine = [](double x, const double *b, double A, double B, double C){ return A*b[0] + B*cos(C*x); };
+		break;
+	case 2:
+		// log(B*x) = log|B| + log|x| при B*x > 0, иначе значение
+		// вне области определения вычисляется напрямую
+		k.basisSize = 1;
+		k.basis = [](double x, double *b){ b[0] = log(std::fabs(x)); };
+		k.combine = [](double x, const double *b, double A, double B, double){
+			return B*x > 0 ? A*(log(std::fabs(B)) + b[0]) : A*log(B*x);
+		};
+		break;
+	case 3:
+		k.basisSize = 1;
+		k.basis = [](double x, double *b){ b[0] = sin(x*x); };
+		k.combine = [](double, const double *b, double A, double B, double){ return A / ( B*b[0] ); };
+		break;
+	default:
+		Q_UNREACHABLE();
+	}
+
+	return k;
+}
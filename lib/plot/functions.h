@@ -0,0 +1,78 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include <QStringList>
+#include <functional>
+#include <cmath>
+
+/* Точность построения сетки x и вычисления функции */
+enum class PlotPrecision
+{
+	Double,			// x = from + step * i, функция в double
+	Compensated,	// x с одним округлением (double-double), функция в double
+	Extended		// x и функция в long double
+};
+
+/* Встроенные функции вида f(x; A, B, C) */
+namespace PlotFunctions
+{
+	/* Разложение функции на часть, не зависящую от параметров (basis),
+	 * и дешевую свертку с параметрами (combine). Базис вычисляется
+	 * один раз для всей сетки x и переиспользуется при переборе A, B, C */
+	struct Kernel
+	{
+		int basisSize = 0;
+		std::function<void(double x, double *basis)> basis;
+		std::function<double(double x, const double *basis, double A, double B, double C)> combine;
+	};
+
+	/* Встроенные функции в виде функторов. Параметры - поля, поэтому
+	 * в цикле по конкретному типу вызов встраивается, а константы
+	 * остаются в регистрах */
+	struct Quadratic
+	{
+		double A, B, C;
+		double operator()(double x) const { return A*(x*x) + B*x + C; }
+	};
+
+	struct Harmonic
+	{
+		double A, B, C;
+		double operator()(double x) const { return A*std::sin(x) + B*std::cos(C*x); }
+	};
+
+	struct Logarithm
+	{
+		double A, B;
+		double operator()(double x) const { return A*std::log(B*x); }
+	};
+
+	struct InverseSine
+	{
+		double A, B;
+		double operator()(double x) const { return A / ( B*std::sin(x*x) ); }
+	};
+
+	/* Пакетное вычисление y[i] = f(x[i]), i < n: один косвенный вызов
+	 * на пакет вместо вызова std::function на каждую точку */
+	using Batch = std::function<void(const double *x, double *y, int n)>;
+
+	// Цикл, инстанцируемый для конкретного функтора
+	template<class F>
+	Batch batch(const F &f)
+	{
+		return [f](const double *x, double *y, int n) {
+			for(int i = 0; i < n; ++i)
+				y[i] = f(x[i]);
+		};
+	}
+
+	PLOTENGINE_EXPORT QStringList names();
+	PLOTENGINE_EXPORT int count();
+
+	PLOTENGINE_EXPORT std::function<double(double)> make(int index, double A, double B, double C);
+	// Специализированный пакет встроенной функции
+	PLOTENGINE_EXPORT Batch makeBatch(int index, double A, double B, double C);
+	PLOTENGINE_EXPORT std::function<long double(long double)> makeExtended(int index, double A, double B, double C);
+	PLOTENGINE_EXPORT Kernel kernel(int index);
+}
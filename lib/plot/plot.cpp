@@ -1,5 +1,7 @@
 #include "plot.h"
 #include "plotimpl.h"
+#include "plotexport.h"
+#include "plotengine.h"
 #include <QEvent>
 #include <QDebug>
 #include <QMetaEnum>
@@ -7,12 +9,18 @@
 #include <QTransform>
 #include <QPaintEvent>
 #include <QRect>
+#include <QRegion>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <QFileInfo>
+#include <QtConcurrent>
 
 Plot::Plot(QWidget *parent)
 	: QWidget(parent)
 {
 	m_pimpl = new PlotImpl(this); // todo
 	setupConnections();
+	setMouseTracking(true);
 }
 
 QVector<QPointF> Plot::series() const
@@ -25,6 +33,16 @@ void Plot::setSeries(const QVector<QPointF> &series)
 	m_pimpl->setSeries(series);
 }
 
+void Plot::takeSeries(const PlotJobHandle &job)
+{
+	m_pimpl->takeSeries(job);
+}
+
+bool Plot::isSeriesResident() const
+{
+	return m_pimpl->isSeriesResident();
+}
+
 QString Plot::functionName() const
 {
 	return m_pimpl->functionName();
@@ -44,6 +62,26 @@ void Plot::setFunction(const std::function<double(double)> &f, const QString &na
 	m_pimpl->setFunction(f, name);
 }
 
+void Plot::setExtendedFunction(const std::function<long double(long double)> &f)
+{
+	m_pimpl->setExtendedFunction(f);
+}
+
+void Plot::setFunctionBatch(const PlotFunctions::Batch &batch)
+{
+	m_pimpl->setFunctionBatch(batch);
+}
+
+void Plot::setPrecision(PlotPrecision precision)
+{
+	m_pimpl->setPrecision(precision);
+}
+
+PlotPrecision Plot::precision() const
+{
+	return m_pimpl->precision();
+}
+
 void Plot::setInterval(double from, double to, double step) {
 	m_pimpl->setInterval(from, to, step);
 }
@@ -62,28 +100,160 @@ bool Plot::isPaused() const
 	return m_pimpl->isPaused();
 }
 
+PlotJobHandle Plot::submit(int priority)
+{
+	return m_pimpl->submit(priority);
+}
+
+PlotJobHandle Plot::attach(const QString &name, QString *error)
+{
+	return m_pimpl->attach(name, error);
+}
+
+PlotJobHandle Plot::currentJob() const
+{
+	return m_pimpl->currentJob();
+}
+
 void Plot::start()
 {
-	m_pimpl->start();
+	m_pimpl->submit();
 }
 
-bool Plot::isRunning()
+bool Plot::isRunning() const
 {
 	return m_pimpl->isRunning();
 }
 
 void Plot::interrupt()
 {
-	m_pimpl->requestInterruption();
+	m_pimpl->interrupt();
+}
+
+void Plot::setProgressive(bool state)
+{
+	m_pimpl->setProgressive(state);
 }
 
-void Plot::paintEvent(QPaintEvent *)
+bool Plot::isProgressive() const
 {
+	return m_pimpl->isProgressive();
+}
+
+void Plot::refresh()
+{
+	const QRect dirty = m_pimpl->takeDirtyRect();
+	const QImage curve = m_pimpl->curve();
+
+	if( dirty.isEmpty() || curve.isNull() )
+		return;
+
+	update(curveTransform(curve.width()).mapRect(dirty).adjusted(-1, -1, 1, 1));
+}
+
+void Plot::paintEvent(QPaintEvent *event)
+{
+	// Фон в физических пикселях экрана, рисуется в логических координатах.
+	// Коэффициент меняется и при переносе окна на другой экран
+	const qreal ratio = devicePixelRatioF();
+
+	if( m_background.isNull() || m_background.devicePixelRatioF() != ratio
+			|| m_background.size() != size() * ratio ) {
+		m_background = QPixmap(size() * ratio);
+		m_background.setDevicePixelRatio(ratio);
+		QPainter bp(&m_background);
+		PlotEngine::renderFrame(&bp, size());
+	}
+
 	QPainter p(this);
-	renderBackground(&p);
-	setupCoordinateTransformatin(&p);
-	renderCoordinateSystem(&p);
-	renderCurve(&p);
+	const QImage curve = m_pimpl->curve();
+	const int side = curve.isNull() ? m_overlay.width() : curve.width();
+	const QTransform transform = curveTransform(qMax(1, side));
+	const QTransform inverted = transform.inverted();
+
+	// Слои копируются только в пределах обновляемой области
+	for(const QRect &rect: event->region()) {
+		// Исходная область фона задается в его пикселях
+		p.drawPixmap(QRectF(rect), m_background, QRectF(QPointF(rect.topLeft()) * ratio, QSizeF(rect.size()) * ratio));
+
+		p.setTransform(transform);
+
+		if( !curve.isNull() ) {
+			const QRect source = inverted.mapRect(QRectF(rect)).toAlignedRect() & curve.rect();
+			p.drawImage(source, curve, source);
+		}
+
+		if( !m_overlay.isNull() ) {
+			const QRect source = inverted.mapRect(QRectF(rect)).toAlignedRect() & m_overlay.rect();
+			p.drawImage(source, m_overlay, source);
+		}
+
+		p.resetTransform();
+	}
+
+	renderOverlay(&p);
+}
+
+void Plot::resizeEvent(QResizeEvent *)
+{
+	m_background = QPixmap();
+}
+
+void Plot::mouseMoveEvent(QMouseEvent *event)
+{
+	double xMaxAbs, yMaxAbs;
+	QPointF point;
+	const QRegion old = overlayRegion();
+
+	// Обратное преобразование PlotEngine::setupCoordinateTransformation()
+	const int scale = qMin(width(), height()) / 2;
+	m_hover = scale > 0 && m_pimpl->normalization(xMaxAbs, yMaxAbs);
+
+	if( m_hover ) {
+		const double x = xMaxAbs * (event->pos().x() - width() / 2) / scale;
+		m_hover = m_pimpl->nearestPoint(x, point);
+	}
+
+	if( m_hover ) {
+		// Разрывы (inf, nan) отмечаются на оси x
+		const double ny = qIsFinite(point.y() / yMaxAbs) ? point.y() / yMaxAbs : 0.0;
+
+		m_hoverPoint = point;
+		m_hoverPos = QPoint(width() / 2 + qRound(scale * point.x() / xMaxAbs),
+							height() / 2 - qRound(scale * ny));
+
+		const QString text = QString("x = %1, y = %2").arg(point.x()).arg(point.y());
+		QRect label = fontMetrics().boundingRect(text).adjusted(-3, -3, 3, 3);
+		label.moveBottomLeft(m_hoverPos + QPoint(6, -6));
+
+		// Подпись не выходит за пределы виджета
+		if( label.right() > width() )
+			label.moveRight(m_hoverPos.x() - 6);
+		if( label.top() < 0 )
+			label.moveTop(m_hoverPos.y() + 6);
+
+		m_hoverLabel = label;
+	}
+
+	// Перерисовывается только слой перекрестия
+	update(old + overlayRegion());
+}
+
+void Plot::leaveEvent(QEvent *)
+{
+	const QRegion old = overlayRegion();
+	m_hover = false;
+	update(old);
+}
+
+void Plot::setMemoryBudget(qint64 bytes)
+{
+	m_pimpl->setMemoryBudget(bytes);
+}
+
+qint64 Plot::memoryBudget() const
+{
+	return m_pimpl->memoryBudget();
 }
 
 int Plot::progress() const
@@ -91,62 +261,123 @@ int Plot::progress() const
 	return m_pimpl->progress();
 }
 
+qint64 Plot::elapsed() const
+{
+	return m_pimpl->elapsed();
+}
+
 void Plot::clear()
 {
 	m_pimpl->clear();
+	m_overlay = QImage();
+	update();
+}
+
+void Plot::setOverlay(const QImage &overlay)
+{
+	m_overlay = overlay;
 	update();
 }
 
-void Plot::setupCoordinateTransformatin(QPainter * p)
+QImage Plot::overlayImage(const QVector<QPointF> &series)
 {
-	// Смещаем все точки так, чтобы (0,0)
-	// соответстовала центру полотна
-	p->translate(width() / 2, height() / 2);
-	// Мультиплицируем координаты точек так,
-	// чтобы полотно лежало между точками
-	// (-1, 1) и (1, -1)
-	int side = qMin(width(), height());
-	p->scale(side/2, -side/2);
+	return series.isEmpty() ? QImage() : PlotImpl::renderSeries(series, overlaySide, Qt::yellow);
 }
 
-void Plot::renderBackground(QPainter *p)
+QImage Plot::renderImage(const QImage &curve, const QSize &size)
 {
-	p->fillRect(rect(), QGradient::ColdEvening);
+	return PlotEngine::renderImage(curve, size);
 }
 
-void Plot::renderCoordinateSystem(QPainter *p)
+QFuture<QString> Plot::exportTo(const QString &fileName, const QSize &size, const PlotExport::Progress &progress) const
 {
-	static const qreal arrowScale = 0.1;
-	static const QPointF arrow[3] = {
-		arrowScale * QPointF(-0.25, -1.0),
-		arrowScale * QPointF(0.0, 0.0),
-		arrowScale * QPointF(0.25, -1.0)
-	};
+	// Ссылка удерживает задачу, даже если ее сменит новый расчет
+	const PlotJobHandle job = m_pimpl->currentJob();
+
+	return QtConcurrent::run(PlotJob::executor(), [job, fileName, size, progress]()
+	{
+		double xMaxAbs, yMaxAbs;
+		QString error;
 
-	// Координатные прямые
-	p->setPen(QPen(Qt::black, 0.005, Qt::SolidLine));
-	QLineF xAxis(-1.0, 0.0, 1.0, 0.0);
-	QLineF yAxis(0.0, -1.0, 0.0, 1.0);
-	p->drawLine(xAxis);
-	p->drawLine(yAxis);
+		if( !job->normalization(xMaxAbs, yMaxAbs) )
+			return QString("Nothing to export");
 
-	// Направляющие координатные стрелки
-	p->save();
-	p->translate(0.0, 1.0);
-	p->drawPolyline(arrow, 3);
-	p->restore();
+		const bool png = QFileInfo(fileName).suffix().toLower() == "png";
+		// Прореживание - первая половина работы для PNG и почти вся для векторных форматов
+		const int share = png ? 50 : 90;
+		const auto series = job->decimate(size.width(), [&](int percent)
+		{
+			if( progress )
+				progress(share * percent / 100);
+		});
 
-	p->save();
-	p->translate(1.0, 0.0);
-	p->rotate(-90);
-	p->drawPolyline(arrow, 3);
-	p->restore();
+		if( series.isEmpty() )
+			return QString("The series changed during export");
+
+		const auto decorate = &PlotEngine::renderFrame;
+		bool ok;
+
+		if( png )
+			ok = PlotExport::exportPng(series, xMaxAbs, yMaxAbs, size, fileName, decorate, &error, [&](int percent)
+			{
+				if( progress )
+					progress(share + (100 - share) * percent / 100);
+			});
+		else
+			ok = PlotExport::exportVector(series, xMaxAbs, yMaxAbs, size, fileName, decorate, &error);
+
+		if( ok && progress )
+			progress(100);
+
+		return ok ? QString() : (error.isEmpty() ? QString("Export failed") : error);
+	});
 }
 
-void Plot::renderCurve(QPainter *p)
+QTransform Plot::curveTransform(int side) const
 {
-	const auto curve = m_pimpl->curve();
-	p->drawImage(QRectF(-1, -1, 2, 2), curve, curve.rect());
+	// То же, что PlotEngine::setupCoordinateTransformation() + drawImage():
+	// пиксели m_curve -> [-1, 1] -> координаты виджета
+	QTransform transform;
+	const int scale = qMin(width(), height()) / 2;
+
+	transform.translate(width() / 2, height() / 2);
+	transform.scale(scale, -scale);
+	transform.translate(-1, -1);
+	transform.scale(2.0 / side, 2.0 / side);
+
+	return transform;
+}
+
+void Plot::renderOverlay(QPainter *p)
+{
+	if( !m_hover )
+		return;
+
+	p->setPen(QPen(Qt::yellow, 1, Qt::DashLine));
+	p->drawLine(0, m_hoverPos.y(), width(), m_hoverPos.y());
+	p->drawLine(m_hoverPos.x(), 0, m_hoverPos.x(), height());
+
+	p->setPen(Qt::black);
+	p->setBrush(Qt::yellow);
+	p->drawEllipse(m_hoverPos, 3, 3);
+
+	p->fillRect(m_hoverLabel, QColor(0, 0, 0, 160));
+	p->setPen(Qt::white);
+	p->drawText(m_hoverLabel, Qt::AlignCenter,
+				QString("x = %1, y = %2").arg(m_hoverPoint.x()).arg(m_hoverPoint.y()));
+}
+
+QRegion Plot::overlayRegion() const
+{
+	if( !m_hover )
+		return QRegion();
+
+	QRegion region(0, m_hoverPos.y() - 1, width(), 3);
+	region += QRect(m_hoverPos.x() - 1, 0, 3, height());
+	region += QRect(m_hoverPos - QPoint(5, 5), QSize(11, 11));
+	region += m_hoverLabel;
+
+	return region;
 }
 
 void Plot::setupConnections()
@@ -4,11 +4,20 @@
 #include <QThread>
 #include <QVector>
 #include <QPointF>
+#include <QImage>
+#include <QPixmap>
+#include <QTransform>
+#include <QFuture>
+#include "functions.h"
+#include "plotjob.h"
+#include "plotexport.h"
 
 class QPaintEvent;
 class QPainter;
 class PlotImpl;
 class QPaintEvent;
+class QMouseEvent;
+class QResizeEvent;
 
 /* График по обеим осям нормирован на единицу */
 class Plot: public QWidget
@@ -19,9 +28,20 @@ public:
 
 	QVector<QPointF> series() const;
 	void setSeries(const QVector<QPointF> &);
+	// Продолжение готового ряда задачи без копирования, см. PlotJob::takeSeries
+	void takeSeries(const PlotJobHandle &);
+	// Ряд в ОЗУ, series() вернет его целиком
+	bool isSeriesResident() const;
 
 	void setFunction(const std::function<double(double)> &, const QString &);
 	QString functionName() const;
+	void setExtendedFunction(const std::function<long double(long double)> &);
+	// Цикл, специализированный под встроенную функцию, см. PlotFunctions::makeBatch
+	void setFunctionBatch(const PlotFunctions::Batch &);
+
+	// Точность против скорости, см. PlotPrecision
+	void setPrecision(PlotPrecision);
+	PlotPrecision precision() const;
 
 	void setParams(double A, double B, double C);
 	void getParams(double &A, double &B, double &C) const;
@@ -29,35 +49,81 @@ public:
 	void setInterval(double from, double to, double step);
 	void getInterval(double &from, double &to, double &step) const;
 
-	// Запускает поток вычислений
+	/* Запускает расчет в общем пуле потоков. Идущий расчет при этом
+	 * отменяется, не задерживая новый. Задачу можно отменить,
+	 * приостановить или дополнить продолжением, см. PlotJob */
+	PlotJobHandle submit(int priority = 0);
+	PlotJobHandle currentJob() const;
+	// Живой просмотр ряда другого процесса, см. SharedSeries
+	PlotJobHandle attach(const QString &name, QString *error = nullptr);
+	// То же, что submit() без приоритета
 	void start();
-	bool isRunning();
-	// Приостанавливает поток вычислений
+	bool isRunning() const;
+	// Приостанавливает текущую задачу
 	void pause(bool state);
 	bool isPaused() const;
-	// Прекращает вычисления
+	// Отменяет текущую задачу
 	void interrupt();
+	// Грубый предпросмотр всего интервала с последующим уточнением
+	void setProgressive(bool);
+	bool isProgressive() const;
 	//isRunning()
 
+	// Перерисовывает только измененную с прошлого раза часть кривой
+	void refresh();
+
 	void paintEvent(QPaintEvent *event) override;
+	void resizeEvent(QResizeEvent *event) override;
+	void mouseMoveEvent(QMouseEvent *event) override;
+	void leaveEvent(QEvent *event) override;
+
+	// Бюджет ОЗУ для ряда в байтах, 0 - без ограничений
+	void setMemoryBudget(qint64);
+	qint64 memoryBudget() const;
 
 	int progress() const;
+	// Длительность последнего запуска, мс
+	qint64 elapsed() const;
 
 	// Удаляет график
 	void clear();
 
+	// Дополнительная кривая поверх графика со своей нормировкой, см. overlayImage()
+	void setOverlay(const QImage &);
+	// Изображение кривой для setOverlay(), можно строить в рабочем потоке
+	static QImage overlayImage(const QVector<QPointF> &);
+	// Ширина overlayImage(), до нее стоит прореживать ряд
+	static const int overlaySide = 512;
+
+	// Фон, координатные оси и кривая в одном изображении (миниатюры, экспорт)
+	static QImage renderImage(const QImage &curve, const QSize &);
+
+	/* Экспорт в файл произвольного размера в пуле PlotJob::executor():
+	 * ряд текущей задачи прореживается поблочно, PNG рисуется по полосам,
+	 * SVG и PDF - прореженным векторным путем. Формат по расширению.
+	 * Результат - текст ошибки, пустой при успехе */
+	QFuture<QString> exportTo(const QString &fileName, const QSize &,
+							  const PlotExport::Progress & = PlotExport::Progress()) const;
+
 signals:
 	void resultReady();
 	void seriesChanged();
 
 private:
-	void setupCoordinateTransformatin(QPainter *);
-	void renderBackground(QPainter *);
-	void renderCoordinateSystem(QPainter *);
-	void renderCurve(QPainter *);
+	QTransform curveTransform(int side) const;
+	void renderOverlay(QPainter *);
+	QRegion overlayRegion() const;
 	void setupConnections();
-	void run();
 
 private:
 	PlotImpl *m_pimpl;
+	// Фон и координатные оси, перерисовываются только при изменении размера
+	QPixmap m_background;
+	QImage m_overlay;
+
+	/* Перекрестие над ближайшей к курсору точкой ряда */
+	bool m_hover = false;
+	QPointF m_hoverPoint;	// Значение точки
+	QPoint m_hoverPos;		// Ее положение на виджете
+	QRect m_hoverLabel;
 };
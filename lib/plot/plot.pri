@@ -1,10 +1,10 @@
+include($$PWD/plotengine-link.pri)
+
 VERSION = 1.0
 QT += widgets
 
 HEADERS += \
-    $$PWD/plot.h \
-    $$PWD/plotimpl.h
+    $$PWD/plot.h
 
 SOURCES += \
-    $$PWD/plot.cpp \
-    $$PWD/plotimpl.cpp
+    $$PWD/plot.cpp
@@ -0,0 +1,23 @@
+# Подключение собранной библиотеки plotengine к приложению,
+# исходники ядра перечислены в plotengine.pri
+QT += concurrent svg
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+PLOTENGINE_DIR = $$shadowed($$PWD)
+win32:CONFIG(debug, debug|release): PLOTENGINE_DIR = $$PLOTENGINE_DIR/debug
+else:win32: PLOTENGINE_DIR = $$PLOTENGINE_DIR/release
+
+LIBS += -L$$PLOTENGINE_DIR -lplotengine
+
+plotengine_shared {
+    DEFINES += PLOTENGINE_SHARED
+} else {
+    # Зависимости статической библиотеки переходят к приложению
+    LIBS += -lz
+    unix:!macx: LIBS += -lrt
+
+    win32-msvc*: PRE_TARGETDEPS += $$PLOTENGINE_DIR/plotengine.lib
+    else: PRE_TARGETDEPS += $$PLOTENGINE_DIR/libplotengine.a
+}
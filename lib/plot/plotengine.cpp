@@ -0,0 +1,164 @@
+#include "plotengine.h"
+#include "plotimpl.h"
+#include "plotjob.h"
+#include "plotexport.h"
+#include "seriesstore.h"
+#include <QPainter>
+#include <QDataStream>
+#include <QLineF>
+#include <limits>
+
+qint64 PlotEngine::gridSize(double from, double to, double step)
+{
+	const double n = std::ceil((to - from) / step) + 1;
+
+	// Отрицательные, бесконечные, nan и сверх maxGridSize - неверная сетка
+	if( !std::isfinite(n) || n < 1 || n > static_cast<double>( maxGridSize ) )
+		return 0;
+
+	return static_cast<qint64>( n );
+}
+
+qint64 PlotEngine::estimateMemory(double from, double to, double step)
+{
+	return SeriesStore::estimate(gridSize(from, to, step));
+}
+
+QVector<QPointF> PlotEngine::compute(const std::function<double(double)> &f,
+									 double from, double to, double step,
+									 PlotPrecision precision,
+									 const PlotFunctions::Batch &batch)
+{
+	const qint64 total = gridSize(from, to, step);
+
+	if( total < 1 || total > std::numeric_limits<int>::max() )
+		return QVector<QPointF>();
+
+	PlotJobConfig config;
+	config.f = f;
+	// Без специализированного пакета тот же цикл вызывает f
+	config.batch = batch ? batch : PlotFunctions::batch(f);
+	config.precision = precision;
+	config.from = from;
+	config.to = to;
+	config.step = step;
+
+	return PlotJob::compute(config);
+}
+
+PlotEngine::Statistics PlotEngine::statistics(const QVector<QPointF> &series)
+{
+	Statistics s;
+	s.count = series.size();
+
+	if( series.isEmpty() )
+		return s;
+
+	PlotImpl::maxAbs(series, s.xMaxAbs, s.yMaxAbs);
+
+	double sum = 0;
+	s.yMin = s.yMax = series.first().y();
+
+	for(const auto &p: series) {
+		s.yMin = qMin(s.yMin, p.y());
+		s.yMax = qMax(s.yMax, p.y());
+		sum += p.y();
+	}
+
+	s.yMean = sum / series.size();
+
+	return s;
+}
+
+QVector<QPointF> PlotEngine::decimate(const QVector<QPointF> &series, int buckets)
+{
+	return PlotExport::decimate(series, buckets);
+}
+
+QImage PlotEngine::rasterize(const QVector<QPointF> &series, int side, const QColor &color)
+{
+	return PlotImpl::renderSeries(series, side, color);
+}
+
+void PlotEngine::setupCoordinateTransformation(QPainter *p, const QSize &size)
+{
+	const int width = size.width();
+	const int height = size.height();
+
+	// Смещаем все точки так, чтобы (0,0)
+	// соответстовала центру полотна
+	p->translate(width / 2, height / 2);
+	// Мультиплицируем координаты точек так,
+	// чтобы полотно лежало между точками
+	// (-1, 1) и (1, -1)
+	int side = qMin(width, height);
+	p->scale(side/2, -side/2);
+}
+
+void PlotEngine::renderFrame(QPainter *p, const QSize &size)
+{
+	static const qreal arrowScale = 0.1;
+	static const QPointF arrow[3] = {
+		arrowScale * QPointF(-0.25, -1.0),
+		arrowScale * QPointF(0.0, 0.0),
+		arrowScale * QPointF(0.25, -1.0)
+	};
+
+	p->save();
+	p->fillRect(QRect(QPoint(0, 0), size), QGradient::ColdEvening);
+	setupCoordinateTransformation(p, size);
+
+	// Координатные прямые
+	p->setPen(QPen(Qt::black, 0.005, Qt::SolidLine));
+	QLineF xAxis(-1.0, 0.0, 1.0, 0.0);
+	QLineF yAxis(0.0, -1.0, 0.0, 1.0);
+	p->drawLine(xAxis);
+	p->drawLine(yAxis);
+
+	// Направляющие координатные стрелки
+	p->save();
+	p->translate(0.0, 1.0);
+	p->drawPolyline(arrow, 3);
+	p->restore();
+
+	p->save();
+	p->translate(1.0, 0.0);
+	p->rotate(-90);
+	p->drawPolyline(arrow, 3);
+	p->restore();
+
+	p->restore();
+}
+
+QImage PlotEngine::renderImage(const QImage &curve, const QSize &size)
+{
+	QImage img(size, QImage::Format_ARGB32_Premultiplied);
+	QPainter p(&img);
+	p.setRenderHint(QPainter::SmoothPixmapTransform);
+
+	renderFrame(&p, size);
+	setupCoordinateTransformation(&p, size);
+	p.drawImage(QRectF(-1, -1, 2, 2), curve, curve.rect());
+
+	return img;
+}
+
+void PlotEngine::write(QDataStream &stream, const Record &record)
+{
+	stream << record.function
+		   << record.A << record.B << record.C
+		   << record.from << record.to << record.step;
+
+	stream << record.series;
+}
+
+bool PlotEngine::read(QDataStream &stream, Record &record)
+{
+	stream >> record.function;
+	stream >> record.A >> record.B >> record.C
+			>> record.from >> record.to >> record.step;
+
+	stream >> record.series;
+
+	return stream.status() == QDataStream::Ok;
+}
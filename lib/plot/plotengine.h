@@ -0,0 +1,90 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include "functions.h"
+#include <QVector>
+#include <QPointF>
+#include <QString>
+#include <QImage>
+#include <QColor>
+#include <functional>
+#include <cmath>
+
+class QPainter;
+class QDataStream;
+
+/* Вычислительное ядро без зависимости от QtWidgets: расчет, статистика,
+ * прореживание, растеризация и сериализация рядов. Те же функции
+ * использует PlotImpl, виджет Plot - лишь тонкая обертка над ними */
+class PLOTENGINE_EXPORT PlotEngine
+{
+public:
+	struct Statistics
+	{
+		qint64 count = 0;
+		double xMaxAbs = 0, yMaxAbs = 0;	// Нормировка кривой
+		double yMin = 0, yMax = 0, yMean = 0;
+	};
+
+	/* Ряд вместе с параметрами, с которыми он получен.
+	 * Формат потока совпадает с файлами store()/load() */
+	struct Record
+	{
+		QString function;
+		double A = 0, B = 0, C = 0;
+		double from = 0, to = 0, step = 0;
+		QVector<QPointF> series;
+	};
+
+	// Наибольшая допустимая сетка, 16 ТБ ряда
+	static const qint64 maxGridSize = Q_INT64_C(1) << 40;
+
+	// Число точек сетки [from, to] с шагом step, 0 для пустой, неверной или больше maxGridSize
+	static qint64 gridSize(double from, double to, double step);
+	// i-й узел сетки с заданной точностью
+	static inline double gridX(double from, double step, qint64 i, PlotPrecision);
+	// Сколько памяти займет ряд на этой сетке, байт
+	static qint64 estimateMemory(double from, double to, double step);
+
+	/* Расчет в вызывающем потоке циклом PlotJob (пакетами, см. PlotFunctions::Batch),
+	 * поэтому ряд совпадает с рассчитанным в приложении; он должен помещаться в QVector */
+	static QVector<QPointF> compute(const std::function<double(double)> &,
+									double from, double to, double step,
+									PlotPrecision = PlotPrecision::Double,
+									const PlotFunctions::Batch & = PlotFunctions::Batch());
+
+	static Statistics statistics(const QVector<QPointF> &);
+	static QVector<QPointF> decimate(const QVector<QPointF> &, int buckets);
+
+	// Кривая, нормированная на единицу, на прозрачном квадрате side x side
+	static QImage rasterize(const QVector<QPointF> &, int side, const QColor & = Qt::white);
+	// Фон и координатные оси; painter остается в исходной системе координат
+	static void renderFrame(QPainter *, const QSize &);
+	// Фон, оси и готовая кривая в одном изображении
+	static QImage renderImage(const QImage &curve, const QSize &);
+	// Переход к координатам [-1, 1] x [-1, 1] с осью y вверх
+	static void setupCoordinateTransformation(QPainter *, const QSize &);
+
+	static void write(QDataStream &, const Record &);
+	static bool read(QDataStream &, Record &);
+};
+
+double PlotEngine::gridX(double from, double step, qint64 i, PlotPrecision precision)
+{
+	if( precision == PlotPrecision::Double )
+		return from + step * i;
+
+	if( precision == PlotPrecision::Extended )
+		return static_cast<double>( static_cast<long double>(from) + static_cast<long double>(step) * i );
+
+	// Сумма from + step * i в арифметике double-double:
+	// произведение и сумма без потери младших разрядов,
+	// округление выполняется один раз
+	const double p = step * i;
+	const double pErr = std::fma(step, static_cast<double>( i ), -p);
+	const double s = from + p;
+	const double bb = s - from;
+	const double sErr = (from - (s - bb)) + (p - bb);
+
+	return s + (sErr + pErr);
+}
@@ -0,0 +1,27 @@
+QT += concurrent svg
+LIBS += -lz
+unix:!macx: LIBS += -lrt
+
+HEADERS += \
+    $$PWD/plotengine.h \
+    $$PWD/plotimpl.h \
+    $$PWD/plotjob.h \
+    $$PWD/functions.h \
+    $$PWD/plotsweep.h \
+    $$PWD/plotexport.h \
+    $$PWD/derivedseries.h \
+    $$PWD/plotreplay.h \
+    $$PWD/seriesstore.h \
+    $$PWD/sharedseries.h
+
+SOURCES += \
+    $$PWD/plotengine.cpp \
+    $$PWD/plotimpl.cpp \
+    $$PWD/plotjob.cpp \
+    $$PWD/functions.cpp \
+    $$PWD/plotsweep.cpp \
+    $$PWD/plotexport.cpp \
+    $$PWD/derivedseries.cpp \
+    $$PWD/plotreplay.cpp \
+    $$PWD/seriesstore.cpp \
+    $$PWD/sharedseries.cpp
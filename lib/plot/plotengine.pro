@@ -0,0 +1,20 @@
+# Вычислительное ядро без QtWidgets для встраивания в сервисы и для
+# приложения (см. simple-plot-viewer.pro, plotengine-link.pri):
+#   qmake plotengine.pro                             - статическая библиотека
+#   qmake "CONFIG+=plotengine_shared" plotengine.pro - разделяемая,
+#   потребители определяют PLOTENGINE_SHARED
+include(plotengine.pri)
+
+VERSION = 1.0
+QT -= widgets
+
+CONFIG += c++11
+
+TARGET = plotengine
+TEMPLATE = lib
+
+plotengine_shared {
+    DEFINES += PLOTENGINE_LIBRARY
+} else {
+    CONFIG += staticlib
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtGlobal>
+
+/* Видимость API вычислительного ядра: библиотека plotengine.pro
+ * собирается с PLOTENGINE_LIBRARY, потребители разделяемой сборки
+ * определяют PLOTENGINE_SHARED, статической - ничего */
+#if defined(PLOTENGINE_LIBRARY)
+#  define PLOTENGINE_EXPORT Q_DECL_EXPORT
+#elif defined(PLOTENGINE_SHARED)
+#  define PLOTENGINE_EXPORT Q_DECL_IMPORT
+#else
+#  define PLOTENGINE_EXPORT
+#endif
@@ -0,0 +1,334 @@
+#include "plotexport.h"
+#include "plotengine.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPdfWriter>
+#include <QPageSize>
+#include <QPageLayout>
+#include <QSvgGenerator>
+#include <QThread>
+#include <QtEndian>
+#include <QtConcurrent>
+#include <zlib.h>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+
+/* Потоковый кодировщик PNG (RGBA, 8 бит): строки сжимаются
+ * по мере поступления и сразу пишутся в IDAT */
+class PngStream
+{
+public:
+	explicit PngStream(QFile *file)
+		: m_file(file)
+	{ }
+
+	~PngStream()
+	{
+		if( m_open )
+			deflateEnd(&m_zs);
+	}
+
+	bool begin(const QSize &size)
+	{
+		static const char signature[] = "\x89PNG\r\n\x1a\n";
+		if( m_file->write(signature, 8) != 8 )
+			return false;
+
+		QByteArray ihdr(13, 0);
+		qToBigEndian<quint32>(size.width(), ihdr.data());
+		qToBigEndian<quint32>(size.height(), ihdr.data() + 4);
+		ihdr[8] = 8;	// Бит на канал
+		ihdr[9] = 6;	// RGBA
+
+		m_zs = z_stream();
+		m_open = deflateInit(&m_zs, Z_DEFAULT_COMPRESSION) == Z_OK;
+
+		return m_open && writeChunk("IHDR", ihdr);
+	}
+
+	bool writeRows(const QImage &band)
+	{
+		QByteArray row(1 + band.width() * 4, 0); // Фильтр 0 + пиксели
+
+		for(int y = 0; y < band.height(); ++y) {
+			memcpy(row.data() + 1, band.constScanLine(y), band.width() * 4);
+			if( !deflateBuffer(row, Z_NO_FLUSH) )
+				return false;
+		}
+
+		return true;
+	}
+
+	bool end()
+	{
+		return deflateBuffer(QByteArray(), Z_FINISH)
+				&& writeChunk("IDAT", m_idat)
+				&& writeChunk("IEND", QByteArray());
+	}
+
+private:
+	bool deflateBuffer(const QByteArray &data, int flush)
+	{
+		const int chunkSize = 1 << 16;
+		char out[chunkSize];
+
+		m_zs.next_in = reinterpret_cast<Bytef *>( const_cast<char *>(data.constData()) );
+		m_zs.avail_in = static_cast<uInt>( data.size() );
+
+		do {
+			m_zs.next_out = reinterpret_cast<Bytef *>( out );
+			m_zs.avail_out = chunkSize;
+
+			if( deflate(&m_zs, flush) == Z_STREAM_ERROR )
+				return false;
+
+			m_idat.append(out, chunkSize - static_cast<int>( m_zs.avail_out ));
+
+			if( m_idat.size() >= chunkSize ) {
+				if( !writeChunk("IDAT", m_idat) )
+					return false;
+				m_idat.clear();
+			}
+		} while( m_zs.avail_out == 0 );
+
+		return true;
+	}
+
+	bool writeChunk(const char *type, const QByteArray &data)
+	{
+		if( data.isEmpty() && qstrcmp(type, "IEND") != 0 )
+			return true;
+
+		char header[8];
+		qToBigEndian<quint32>(data.size(), header);
+		memcpy(header + 4, type, 4);
+
+		uLong crc = crc32(0, reinterpret_cast<const Bytef *>(type), 4);
+		crc = crc32(crc, reinterpret_cast<const Bytef *>(data.constData()), static_cast<uInt>( data.size() ));
+
+		char footer[4];
+		qToBigEndian<quint32>(static_cast<quint32>( crc ), footer);
+
+		return m_file->write(header, 8) == 8
+				&& m_file->write(data) == data.size()
+				&& m_file->write(footer, 4) == 4;
+	}
+
+private:
+	QFile *m_file;
+	z_stream m_zs;
+	bool m_open = false;
+	QByteArray m_idat;
+};
+
+QPainterPath normalizedPath(const QVector<QPointF> &series, double xMaxAbs, double yMaxAbs)
+{
+	QPainterPath path;
+
+	if( series.isEmpty() )
+		return path;
+
+	path.moveTo(series.first().x() / xMaxAbs, series.first().y() / yMaxAbs);
+	for(int i = 1; i < series.size(); ++i)
+		path.lineTo(series[i].x() / xMaxAbs, series[i].y() / yMaxAbs);
+
+	return path;
+}
+
+void renderPath(QPainter *p, const QPainterPath &path, const QSize &size)
+{
+	p->save();
+	PlotEngine::setupCoordinateTransformation(p, size);
+	p->setPen(QPen(Qt::white, 0.005, Qt::SolidLine));
+	p->drawPath(path);
+	p->restore();
+}
+
+}
+
+QVector<QPointF> PlotExport::decimate(const QVector<QPointF> &series, int buckets)
+{
+	if( buckets <= 0 || series.size() <= 4 * buckets )
+		return series;
+
+	Decimator decimator(series.first().x(), series.last().x(), buckets);
+	decimator.add(series.constData(), series.size());
+
+	return decimator.finish();
+}
+
+/* Decimator */
+
+PlotExport::Decimator::Decimator(double xFirst, double xLast, int buckets)
+	: m_x0(xFirst)
+	, m_width(xLast - xFirst)
+	, m_buckets(qMax(1, buckets))
+{
+	m_result.reserve(4 * m_buckets + 1);
+}
+
+void PlotExport::Decimator::add(const QPointF *points, qint64 count)
+{
+	for(qint64 i = 0; i < count; ++i, ++m_index) {
+		const QPointF &p = points[i];
+		const int bucket = bucketOf(p.x());
+
+		if( bucket != m_bucket ) {
+			flush();
+
+			m_bucket = bucket;
+			m_first = m_min = m_max = p;
+			m_iMin = m_iMax = m_index;
+		}
+		else {
+			if( p.y() < m_min.y() ) {
+				m_min = p;
+				m_iMin = m_index;
+			}
+			if( p.y() > m_max.y() ) {
+				m_max = p;
+				m_iMax = m_index;
+			}
+		}
+
+		m_last = p;
+	}
+}
+
+QVector<QPointF> PlotExport::Decimator::finish()
+{
+	flush();
+	m_bucket = -1;
+
+	return m_result;
+}
+
+int PlotExport::Decimator::bucketOf(double x) const
+{
+	return m_width > 0 ? qMin(m_buckets - 1, static_cast<int>( (x - m_x0) / m_width * m_buckets )) : 0;
+}
+
+void PlotExport::Decimator::flush()
+{
+	if( m_bucket < 0 )
+		return;
+
+	// Первая, экстремумы и последняя точки столбца в порядке следования
+	m_result << m_first;
+	m_result << (m_iMin < m_iMax ? m_min : m_max);
+	m_result << (m_iMin < m_iMax ? m_max : m_min);
+	m_result << m_last;
+}
+
+bool PlotExport::exportPng(const QVector<QPointF> &series, double xMaxAbs, double yMaxAbs,
+						   const QSize &size, const QString &fileName,
+						   const Decoration &decorate, QString *error,
+						   const Progress &progress)
+{
+	QFile file(fileName);
+
+	if( !file.open(QFile::WriteOnly | QFile::Truncate) ) {
+		if( error )
+			*error = file.errorString();
+		return false;
+	}
+
+	const QPainterPath path = normalizedPath(decimate(series, size.width()), xMaxAbs, yMaxAbs);
+	const int bandHeight = 256;
+	const int bands = (size.height() + bandHeight - 1) / bandHeight;
+	// Одновременно в памяти не больше полос, чем потоков
+	const int batch = qMax(1, QThread::idealThreadCount());
+
+	PngStream png(&file);
+	bool ok = png.begin(size);
+
+	for(int first = 0; ok && first < bands; first += batch) {
+		QVector<int> indexes;
+		for(int i = first; i < qMin(bands, first + batch); ++i)
+			indexes << i;
+
+		const QVector<QImage> images = QtConcurrent::blockingMapped<QVector<QImage>>(indexes, [&](int band)
+		{
+			const int top = band * bandHeight;
+			QImage img(size.width(), qMin(bandHeight, size.height() - top), QImage::Format_RGBA8888);
+			img.fill(Qt::transparent);
+
+			QPainter p(&img);
+			p.setRenderHint(QPainter::Antialiasing);
+			p.translate(0, -top);
+			decorate(&p, size);
+			renderPath(&p, path, size);
+
+			return img;
+		});
+
+		for(const auto &img: images)
+			ok = ok && png.writeRows(img);
+
+		if( progress )
+			progress(100 * qMin(bands, first + batch) / bands);
+	}
+
+	ok = ok && png.end();
+
+	if( !ok && error )
+		*error = file.error() != QFile::NoError ? file.errorString() : QString("PNG encoding failed");
+
+	return ok;
+}
+
+bool PlotExport::exportVector(const QVector<QPointF> &series, double xMaxAbs, double yMaxAbs,
+							  const QSize &size, const QString &fileName,
+							  const Decoration &decorate, QString *error)
+{
+	const QString suffix = QFileInfo(fileName).suffix().toLower();
+	// Вершин не больше, чем различимо при заданном размере
+	const QPainterPath path = normalizedPath(decimate(series, size.width()), xMaxAbs, yMaxAbs);
+
+	if( suffix == "svg" ) {
+		QSvgGenerator svg;
+		svg.setFileName(fileName);
+		svg.setSize(size);
+		svg.setViewBox(QRect(QPoint(0, 0), size));
+
+		QPainter p;
+		if( !p.begin(&svg) ) {
+			if( error )
+				*error = QString("Cannot write %1").arg(fileName);
+			return false;
+		}
+
+		decorate(&p, size);
+		renderPath(&p, path, size);
+		return p.end();
+	}
+
+	if( suffix == "pdf" ) {
+		QPdfWriter pdf(fileName);
+		pdf.setResolution(72); // Один пиксель - один пункт
+		pdf.setPageLayout(QPageLayout(QPageSize(size, QPageSize::Point, QString(), QPageSize::ExactMatch),
+									  QPageLayout::Portrait, QMarginsF()));
+
+		QPainter p;
+		if( !p.begin(&pdf) ) {
+			if( error )
+				*error = QString("Cannot write %1").arg(fileName);
+			return false;
+		}
+
+		decorate(&p, size);
+		renderPath(&p, path, size);
+		return p.end();
+	}
+
+	if( error )
+		*error = QString("Unsupported vector format: %1").arg(suffix);
+
+	return false;
+}
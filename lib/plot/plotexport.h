@@ -0,0 +1,61 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include <QVector>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+#include <functional>
+
+class QPainter;
+
+/* Экспорт кривой в файлы произвольного размера */
+namespace PlotExport
+{
+	// Отрисовка фона и осей на полотне заданного размера
+	using Decoration = std::function<void(QPainter *, const QSize &)>;
+	// Процент выполнения, вызывается в рабочем потоке
+	using Progress = std::function<void(int percent)>;
+
+	/* Прореживание упорядоченного по x ряда: в каждом из buckets столбцов
+	 * остаются первая, минимальная, максимальная и последняя точки,
+	 * поэтому при отрисовке в buckets пикселей кривая не меняется */
+	PLOTENGINE_EXPORT QVector<QPointF> decimate(const QVector<QPointF> &, int buckets);
+
+	/* То же прореживание по частям: точки подаются порциями в порядке
+	 * следования, в памяти остается только результат. Границы столбцов
+	 * задаются x первой и последней точек ряда */
+	class PLOTENGINE_EXPORT Decimator
+	{
+	public:
+		Decimator(double xFirst, double xLast, int buckets);
+
+		void add(const QPointF *points, qint64 count);
+		QVector<QPointF> finish();
+
+	private:
+		int bucketOf(double x) const;
+		void flush();
+
+	private:
+		double m_x0, m_width;
+		int m_buckets;
+		int m_bucket = -1;		// Столбец текущей группы точек
+		qint64 m_index = 0;		// Номер следующей точки
+		QPointF m_first, m_min, m_max, m_last;
+		qint64 m_iMin = 0, m_iMax = 0;
+		QVector<QPointF> m_result;
+	};
+
+	/* PNG рисуется параллельно полосами и построчно сжимается в файл,
+	 * целиком изображение в памяти не хранится */
+	PLOTENGINE_EXPORT bool exportPng(const QVector<QPointF> &, double xMaxAbs, double yMaxAbs,
+				   const QSize &, const QString &fileName,
+				   const Decoration &, QString *error = nullptr,
+				   const Progress &progress = Progress());
+
+	// SVG или PDF, по расширению файла
+	PLOTENGINE_EXPORT bool exportVector(const QVector<QPointF> &, double xMaxAbs, double yMaxAbs,
+					  const QSize &, const QString &fileName,
+					  const Decoration &, QString *error = nullptr);
+}
@@ -1,19 +1,29 @@
 #include "plotimpl.h"
-#include <QDebug>
-#include <QMutexLocker>
+#include "sharedseries.h"
 #include <QPainter>
+#include <QPainterPath>
 #include <QImage>
-#include <QWidget>
-#include <cmath>
 
 PlotImpl::PlotImpl(QObject *parent)
-	: QThread (parent)
-{ }
+	: QObject (parent)
+{
+	setCurrent(PlotJob::create(config()));
+}
+
+PlotImpl::~PlotImpl()
+{
+	// Задача досчитывает в фоне и удаляется вместе с последней ссылкой
+	m_current->cancel();
+}
 
 QVector<QPointF> PlotImpl::series() const
 {
-	QMutexLocker locker(&m_mutex);
-	return m_series;
+	return m_current->series();
+}
+
+bool PlotImpl::isSeriesResident() const
+{
+	return m_current->isResident();
 }
 
 QString PlotImpl::functionName() const
@@ -22,7 +32,16 @@ QString PlotImpl::functionName() const
 }
 
 void PlotImpl::setSeries(const QVector<QPointF> &series) {
-	m_series = series;
+	const PlotJobHandle job = PlotJob::create(config());
+	job->setSeries(series);
+	setCurrent(job);
+}
+
+void PlotImpl::takeSeries(const PlotJobHandle &source)
+{
+	const PlotJobHandle job = PlotJob::create(config());
+	job->takeSeries(*source);
+	setCurrent(job);
 }
 
 void PlotImpl::getParams(double &A, double &B, double &C) const
@@ -42,6 +61,27 @@ void PlotImpl::setParams(double A, double B, double C)
 void PlotImpl::setFunction(const std::function<double (double)> &f, const QString &name) {
 	m_f = f;
 	m_fName = name;
+	m_batch = PlotFunctions::Batch();
+}
+
+void PlotImpl::setExtendedFunction(const std::function<long double(long double)> &f)
+{
+	m_fExtended = f;
+}
+
+void PlotImpl::setFunctionBatch(const PlotFunctions::Batch &batch)
+{
+	m_batch = batch;
+}
+
+void PlotImpl::setPrecision(PlotPrecision precision)
+{
+	m_precision = precision;
+}
+
+PlotPrecision PlotImpl::precision() const
+{
+	return m_precision;
 }
 
 void PlotImpl::getInterval(double &from, double &to, double &step) const
@@ -57,173 +97,206 @@ void PlotImpl::setInterval(double from, double to, double step) {
 	m_step = step;
 }
 
-void PlotImpl::pause(bool state) {
-	m_paused.storeRelaxed(static_cast<int>(state));
+PlotJobHandle PlotImpl::submit(int priority)
+{
+	PlotJobConfig jobConfig = config();
+	jobConfig.priority = priority;
+
+	const PlotJobHandle job = PlotJob::create(jobConfig);
+
+	// Ряд завершенной или загруженной задачи продолжается (он переносится,
+	// а не копируется), замененная же на ходу задача начинается заново
+	if( !m_current->isActive() && !m_current->isEmpty() )
+		job->takeSeries(*m_current);
+
+	setCurrent(job);
+	job->start();
 
-	if( !state )
-		m_activeCalculate.notify_one();
+	return job;
 }
 
-bool PlotImpl::isPaused() const
+PlotJobHandle PlotImpl::attach(const QString &name, QString *error)
 {
-	return static_cast<bool>( m_paused );
+	QSharedPointer<SharedSeriesReader> reader(new SharedSeriesReader);
+
+	if( !reader->attach(name, error) )
+		return PlotJobHandle();
+
+	PlotJobConfig jobConfig;
+	jobConfig.shared = reader;
+
+	const PlotJobHandle job = PlotJob::create(jobConfig);
+	setCurrent(job);
+	job->start();
+
+	return job;
 }
 
-QImage PlotImpl::curve() const
+PlotJobHandle PlotImpl::currentJob() const
 {
-	QMutexLocker locker(&m_mutex);
-	return m_curve;
+	return m_current;
 }
 
-int PlotImpl::progress() const
+bool PlotImpl::isRunning() const
 {
-	QMutexLocker locker(&m_mutex);
-	int percents = 0;
-
-	if( m_series.size() > 0 ) {
-		percents += 0.30 * static_cast<int>( std::ceil(100.0 * (m_series.last().x() - m_from) / (m_to - m_from)) );
-		percents += 0.30 * static_cast<int>( std::ceil(100.0 * m_observedPoints / m_series.size()) );
-		percents += 0.40 * static_cast<int>( std::ceil(100.0 * m_printedPoints / m_series.size()) );
-	}
+	return m_current->isActive();
+}
 
-	return percents;
+void PlotImpl::pause(bool state) {
+	m_current->pause(state);
 }
 
-void PlotImpl::clear()
+bool PlotImpl::isPaused() const
 {
-	QMutexLocker locker (&m_mutex);
-	m_series.clear();
-	m_curve = QImage();
-	m_printedPoints = 0;
-	m_observedPoints = 0;
+	return m_current->isPaused();
 }
 
-/* Private */
-
-void PlotImpl::run() {
-	QMutexLocker locker (&m_calculating);
-	calculate();
-	findMaxAbs();
-	render();
-
-	emit resultReady();
+void PlotImpl::interrupt()
+{
+	m_current->cancel();
 }
 
-void PlotImpl::pauseTest()
+void PlotImpl::setProgressive(bool state)
 {
-	if( m_paused.loadRelaxed() )
-		m_activeCalculate.wait(&m_calculating);
+	m_progressive = state;
 }
 
-void PlotImpl::calculate()
+bool PlotImpl::isProgressive() const
 {
-	const int size = static_cast<int>( std::ceil((m_to - m_from) / m_step) ) + 1;
-	const int currentSize = m_series.size();
-	QVector<QPointF> pointSegment; pointSegment.reserve(segmentSize);
-	double x = 0;
+	return m_progressive;
+}
 
-	for(int i = currentSize; i < size; ++i) {
-		x = m_from + m_step * i;
+qint64 PlotImpl::elapsed() const
+{
+	return m_current->elapsed();
+}
 
-		if( isInterruptionRequested() )
-			return;
+QImage PlotImpl::curve() const
+{
+	return m_current->curve();
+}
 
-		pauseTest();
+QRect PlotImpl::takeDirtyRect()
+{
+	return m_current->takeDirtyRect();
+}
 
-		pointSegment << QPointF(x, m_f(x));
+bool PlotImpl::nearestPoint(double x, QPointF &point) const
+{
+	return m_current->nearestPoint(x, point);
+}
 
-		if( i % segmentSize == 0 || i == size - 1 ) { // Сегмент заполнен
-			QMutexLocker locker(&m_mutex);
-			m_series << pointSegment;
+bool PlotImpl::normalization(double &xMaxAbs, double &yMaxAbs) const
+{
+	return m_current->normalization(xMaxAbs, yMaxAbs);
+}
 
-			pointSegment.clear();
-		}
-	}
+void PlotImpl::setMemoryBudget(qint64 bytes)
+{
+	m_budget = bytes;
 }
 
-void PlotImpl::findMaxAbs()
+qint64 PlotImpl::memoryBudget() const
 {
-	const int size = m_series.size();
+	return m_budget;
+}
 
-	if( size > 0 ) {
-		// Поиск экстремумов
-		yMaxAbs = 0;
-		xMaxAbs = 0;
+qint64 PlotImpl::bytesOnDisk() const
+{
+	return m_current->bytesOnDisk();
+}
 
-		for(int i = 0; i < size; ++i) {
-			if( isInterruptionRequested() )
-				return;
+int PlotImpl::progress() const
+{
+	return m_current->progress();
+}
 
-			pauseTest();
+void PlotImpl::clear()
+{
+	setCurrent(PlotJob::create(config()));
+}
 
-			yMaxAbs = qMax(qAbs(yMaxAbs), qAbs(m_series[i].y()));
+void PlotImpl::maxAbs(const QVector<QPointF> &series, double &xMaxAbs, double &yMaxAbs)
+{
+	xMaxAbs = 0;
+	yMaxAbs = 0;
 
-			if( i % segmentSize == 0 || i == size  - 1) {
-				QMutexLocker locker(&m_mutex);
-				m_observedPoints = i;
-			}
-		}
+	for(const auto &p: series)
+		yMaxAbs = qMax(yMaxAbs, qAbs(p.y()));
 
-		xMaxAbs = qMax(qAbs(m_series.first().x()), qAbs(m_series.last().x()));
-	}
+	if( !series.isEmpty() )
+		xMaxAbs = qMax(qAbs(series.first().x()), qAbs(series.last().x()));
 }
 
-void PlotImpl::render()
+QImage PlotImpl::renderSeries(const QVector<QPointF> &series, int side, const QColor &color)
 {
-	const int size = m_series.size();
+	QImage img = emptyImage(side);
 
-	if( size > 0) {
-		const QPointF beginPoint = {m_series.first().x() / xMaxAbs, m_series.first().y() / yMaxAbs };
-		QPainterPath curve;
-		QPointF np; // Следующая точка
+	if( series.isEmpty() )
+		return img;
 
-		curve.moveTo(beginPoint);
-		for(int i = 1; i < size; ++i) {
-			if( isInterruptionRequested() )
-				return;
+	double xMax, yMax;
+	maxAbs(series, xMax, yMax);
 
-			pauseTest();
+	QPainterPath curve;
+	curve.moveTo(series.first().x() / xMax, series.first().y() / yMax);
+	for(int i = 1; i < series.size(); ++i)
+		curve.lineTo(series[i].x() / xMax, series[i].y() / yMax);
 
-			// Нормировка
-			np = m_series[i];
+	QPainter p(&img);
+	p.translate(side / 2, side / 2);
+	p.scale(side/2, side/2);
+	p.setPen(QPen(color, 0.005, Qt::SolidLine));
+	p.drawPath(curve);
 
-			np.setX( np.x() / xMaxAbs );
-			np.setY( np.y() / yMaxAbs );
+	return img;
+}
 
-			curve.lineTo(np);
+QImage PlotImpl::emptyImage(int side) // side - качество изображения
+{
+	const auto fmt  = QImage::Format_RGBA8888; // Цветопередача
+	QImage img (side, side, fmt);
 
-			if( i % segmentSize == 0 || i == size - 1) {
-				QMutexLocker locker(&m_mutex);
+	img.fill(Qt::transparent);
+	return img;
+}
 
-				if( m_curve.isNull() )
-					m_curve = emptyImage();
+/* Private */
 
-				QPainter p(&m_curve);
-				// Трансформация
-				const int side = m_curve.width();
-				p.translate(side / 2, side / 2);
-				p.scale(side/2, side/2);
+PlotJobConfig PlotImpl::config() const
+{
+	PlotJobConfig jobConfig;
+	jobConfig.f = m_f;
+	jobConfig.fExtended = m_fExtended;
+	jobConfig.batch = m_batch;
+	jobConfig.precision = m_precision;
+	jobConfig.from = m_from;
+	jobConfig.to = m_to;
+	jobConfig.step = m_step;
+	jobConfig.progressive = m_progressive;
+	jobConfig.budget = m_budget;
+
+	return jobConfig;
+}
 
-				// Отрисовка
-				p.setPen(QPen(Qt::white, 0.005, Qt::SolidLine));
-				p.drawPath(curve);
+void PlotImpl::setCurrent(const PlotJobHandle &job)
+{
+	if( m_current )
+		m_current->cancel();
 
-				m_printedPoints = i;
-				locker.unlock();
+	m_current = job;
 
-				curve.clear();
-				curve.moveTo(np); //should be?
-			}
-		}
-	}
-}
+	PlotJob *raw = job.data();
+	connect(raw, &PlotJob::finished, this, [this, raw]()
+	{
+		// Замененная задача завершается молча
+		if( m_current.data() != raw )
+			return;
 
-QImage PlotImpl::emptyImage()
-{
-	const auto side = 512; // Качество изображения
-	const auto fmt  = QImage::Format_RGBA8888; // Цветопередача
-	QImage img (side, side, fmt);
+		// Досрочно остановленный прогрессивный расчет оставляет более крупный шаг
+		if( raw->step() != raw->config().step )
+			m_step = raw->step();
 
-	img.fill(Qt::transparent);
-	return img;
+		emit resultReady();
+	});
 }
@@ -1,70 +1,108 @@
 #pragma once
 
-#include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
-#include <QAtomicInt>
+#include <QObject>
 #include <QVector>
 #include <QPointF>
 #include <QImage>
+#include <QColor>
 #include <functional>
-
-class PlotImpl: public QThread
+#include "plotengine_global.h"
+#include "functions.h"
+#include "plotjob.h"
+
+/* Параметры графика и текущая задача расчета. Каждый запуск создает
+ * новую PlotJob, а предыдущая, если еще идет, отменяется и досчитывает
+ * в фоне в собственные буферы, не задерживая новую */
+class PLOTENGINE_EXPORT PlotImpl: public QObject
 {
 	Q_OBJECT
 public:
 	PlotImpl(QObject *parent);
+	~PlotImpl();
 
 	void setSeries(const QVector<QPointF> &);
+	// Новая задача забирает готовый ряд job без копирования
+	void takeSeries(const PlotJobHandle &job);
 	QVector<QPointF> series() const;
+	bool isSeriesResident() const;
 
 	void setParams(double A, double B, double C);
 	void getParams(double &A, double &B, double &C) const;
 
 	void setFunction(const std::function<double(double)> &f, const QString &);
 	QString functionName() const;
+	// Необязательная версия функции для PlotPrecision::Extended
+	void setExtendedFunction(const std::function<long double(long double)> &);
+	// Необязательный пакет той же функции, сбрасывается в setFunction()
+	void setFunctionBatch(const PlotFunctions::Batch &);
+
+	void setPrecision(PlotPrecision);
+	PlotPrecision precision() const;
 
 	void setInterval(double from, double to, double step);
 	void getInterval(double &from, double &to, double &step) const;
 
+	/* Запускает расчет с текущими параметрами и делает его текущим.
+	 * Если текущая задача завершена, новая продолжает ее ряд */
+	PlotJobHandle submit(int priority = 0);
+	PlotJobHandle currentJob() const;
+	/* Подключается к ряду в разделяемой памяти (см. SharedSeries)
+	 * и показывает его до interrupt(). При ошибке возвращает пустую ссылку */
+	PlotJobHandle attach(const QString &name, QString *error = nullptr);
+	bool isRunning() const;
+
 	void pause(bool state);
 	bool isPaused() const;
+	void interrupt();
+
+	/* Прогрессивный режим: сначала весь интервал обсчитывается
+	 * с шагом previewStride, затем шаг уменьшается вдвое за проход */
+	void setProgressive(bool);
+	bool isProgressive() const;
 
 	QImage curve() const;
+	// Область curve(), измененная с прошлого вызова
+	QRect takeDirtyRect();
+
+	// Ближайшая по x точка ряда без его копирования
+	bool nearestPoint(double x, QPointF &point) const;
+	// Коэффициенты нормировки текущей кривой
+	bool normalization(double &xMaxAbs, double &yMaxAbs) const;
+
+	// Бюджет ОЗУ для ряда, сверх него точки уходят во временный файл
+	void setMemoryBudget(qint64 bytes);
+	qint64 memoryBudget() const;
+	qint64 bytesOnDisk() const;
 
 	int progress() const;
+	// Длительность последнего запуска, мс
+	qint64 elapsed() const;
 
 	void clear();
 
+	// Нормировка и отрисовка готового ряда целиком, вне потока вычислений
+	static void maxAbs(const QVector<QPointF> &, double &xMaxAbs, double &yMaxAbs);
+	static QImage renderSeries(const QVector<QPointF> &, int side, const QColor &color = Qt::white);
+	static QImage emptyImage(int side = 512);
+
 signals:
+	// Только для текущей задачи, о замененных не сообщается
 	void resultReady();
 
 private:
-	void run();
-	void pauseTest();
-	void calculate();
-	void findMaxAbs();
-	void render();
-	QImage emptyImage();
+	PlotJobConfig config() const;
+	void setCurrent(const PlotJobHandle &);
 
 private:
 	std::function<double(double)> m_f;
+	std::function<long double(long double)> m_fExtended;
+	PlotFunctions::Batch m_batch;
 	QString m_fName;
+	PlotPrecision m_precision = PlotPrecision::Double;
 	double m_from = 0, m_to = 0, m_step = 0;
 	double m_A = 0, m_B = 0, m_C = 0;
-	double yMaxAbs = 0, xMaxAbs = 0;
-
-	QWaitCondition m_activeCalculate;
-	QMutex m_calculating;
-	QAtomicInt m_paused = 0;
-
-	/* Обработанные точки добавляются пакетом,
-	 * рамзер которого определяет segmentSize */
-	const int segmentSize = 500;
+	bool m_progressive = false;
+	qint64 m_budget = 0;
 
-	mutable QMutex m_mutex;		// Защищает доступ к определенным ниже полям
-	QVector<QPointF> m_series;
-	QImage m_curve;
-	int m_printedPoints = 0;	// Добавлено на m_curves
-	int m_observedPoints = 0;	// Нормировано
+	PlotJobHandle m_current;	// Никогда не пуста, до первого запуска - Idle
 };
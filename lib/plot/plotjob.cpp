@@ -0,0 +1,842 @@
+#include "plotjob.h"
+#include "plotimpl.h"
+#include "plotengine.h"
+#include "sharedseries.h"
+#include "plotexport.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPainterPath>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <cmath>
+#include <limits>
+
+/* Исполнитель удаляет обертку после выполнения, задача же удаляется
+ * вместе с последней ссылкой на нее, которая может быть и у обертки */
+class PlotJobRunner: public QRunnable
+{
+public:
+	explicit PlotJobRunner(const PlotJobHandle &job)
+		: m_job(job)
+	{ }
+
+	void run() override
+	{
+		m_job->run();
+	}
+
+private:
+	PlotJobHandle m_job;
+};
+
+PlotJob::PlotJob(const PlotJobConfig &config)
+	: QObject(nullptr)
+	, m_config(config)
+	, m_step(config.step)
+{
+	m_series.setBudget(config.budget);
+}
+
+PlotJobHandle PlotJob::create(const PlotJobConfig &config)
+{
+	// Последняя ссылка может освободиться в потоке исполнителя
+	return PlotJobHandle(new PlotJob(config), &QObject::deleteLater);
+}
+
+bool PlotJob::fitsProgressive(qint64 points, qint64 budget)
+{
+	if( points < 1 || points > std::numeric_limits<int>::max() / static_cast<qint64>( sizeof(double) ) )
+		return false;
+
+	// Плотный массив значений не вытесняется на диск, а ряд копится
+	// рядом с ним до конца расчета: бюджет делят обе копии
+	const qint64 pointBytes = static_cast<qint64>( sizeof(double) + sizeof(QPointF) );
+	return budget <= 0 || points <= budget / pointBytes;
+}
+
+QVector<QPointF> PlotJob::compute(const PlotJobConfig &config)
+{
+	// Задача не попадает в исполнитель, поэтому может жить на стеке
+	PlotJob job(config);
+	job.calculate();
+
+	return job.series();
+}
+
+QThreadPool *PlotJob::executor()
+{
+	static QThreadPool pool;
+	return &pool;
+}
+
+void PlotJob::start()
+{
+	{
+		QMutexLocker locker(&m_stateMutex);
+		if( m_state != Idle )
+			return;
+
+		m_state = Queued;
+	}
+
+	if( m_config.shared ) {
+		/* Слежение за разделяемой памятью длится до отмены и почти все
+		 * время спит, поэтому идет в своем потоке, а не занимает исполнитель */
+		const PlotJobHandle job = sharedFromThis();
+		QThread *thread = QThread::create([job]() { job->run(); });
+
+		connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+		thread->start();
+		return;
+	}
+
+	executor()->start(new PlotJobRunner(sharedFromThis()), m_config.priority);
+}
+
+void PlotJob::cancel()
+{
+	m_canceled.storeRelaxed(1);
+
+	QMutexLocker locker(&m_pauseMutex);
+	m_resumed.wakeAll();
+}
+
+void PlotJob::pause(bool state)
+{
+	m_paused.storeRelaxed(static_cast<int>(state));
+
+	if( !state ) {
+		QMutexLocker locker(&m_pauseMutex);
+		m_resumed.wakeAll();
+	}
+}
+
+bool PlotJob::isPaused() const
+{
+	return static_cast<bool>( m_paused.loadRelaxed() );
+}
+
+PlotJob::State PlotJob::state() const
+{
+	QMutexLocker locker(&m_stateMutex);
+	return m_state;
+}
+
+bool PlotJob::isActive() const
+{
+	const State s = state();
+	return s == Queued || s == Running;
+}
+
+bool PlotJob::wait(unsigned long msecs)
+{
+	QMutexLocker locker(&m_stateMutex);
+
+	while( m_state == Queued || m_state == Running )
+		if( !m_stateChanged.wait(&m_stateMutex, msecs) )
+			return false;
+
+	return true;
+}
+
+void PlotJob::then(const std::function<void()> &continuation)
+{
+	// Оба пути вызова ниже выполняются в потоке задачи, флаг исключает повтор
+	const QSharedPointer<bool> done(new bool(false));
+	const auto invoke = [this, continuation, done]()
+	{
+		if( *done || state() != Finished )
+			return;
+
+		*done = true;
+		continuation();
+	};
+
+	/* Соединение ставится до проверки состояния: иначе задача могла бы
+	 * завершиться между ними и finished() прошел бы мимо продолжения.
+	 * Контекст this: finished() испускается в потоке исполнителя, соединение очередное */
+	connect(this, &PlotJob::finished, this, invoke);
+
+	if( state() == Finished )
+		QMetaObject::invokeMethod(this, invoke, Qt::QueuedConnection);
+}
+
+const PlotJobConfig &PlotJob::config() const
+{
+	return m_config;
+}
+
+double PlotJob::step() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_step;
+}
+
+void PlotJob::setSeries(const QVector<QPointF> &series)
+{
+	QMutexLocker locker(&m_mutex);
+	m_series.clear();
+	m_series.append(series);
+	// Загруженный ряд мог быть получен не на текущей сетке
+	m_uniform = series.isEmpty() || series.last().x() == xAt(series.size() - 1);
+}
+
+void PlotJob::takeSeries(PlotJob &source)
+{
+	if( &source == this )
+		return;
+
+	QMutexLocker locker(&m_mutex);
+	QMutexLocker sourceLocker(&source.m_mutex);
+
+	m_series.clear();
+	m_series.swap(source.m_series);
+	m_uniform = m_series.isEmpty() || m_series.last().x() == xAt(m_series.size() - 1);
+}
+
+QVector<QPointF> PlotJob::series() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	if( m_series.bytesOnDisk() > 0 )
+		return QVector<QPointF>();
+
+	return m_series.toVector();
+}
+
+bool PlotJob::isEmpty() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_series.isEmpty();
+}
+
+bool PlotJob::isResident() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_series.bytesOnDisk() == 0 && m_series.size() <= std::numeric_limits<int>::max();
+}
+
+QImage PlotJob::curve() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_curve;
+}
+
+QRect PlotJob::takeDirtyRect()
+{
+	QMutexLocker locker(&m_mutex);
+	const QRect dirty = m_dirty;
+	m_dirty = QRect();
+
+	return dirty;
+}
+
+bool PlotJob::nearestPoint(double x, QPointF &point) const
+{
+	QMutexLocker locker(&m_mutex);
+	const qint64 size = m_series.size();
+
+	if( size == 0 )
+		return false;
+
+	if( m_uniform && m_step > 0 ) {
+		const double i = std::round((x - m_config.from) / m_step);
+		point = m_series.at(static_cast<qint64>( qBound(0.0, i, size - 1.0) ));
+		return true;
+	}
+
+	// Неравномерная сетка: ряд упорядочен по x, ищется первая точка не левее x
+	qint64 lo = 0, hi = size;
+	while( lo < hi ) {
+		const qint64 mid = lo + (hi - lo) / 2;
+		if( m_series.at(mid).x() < x )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if( lo == size )
+		--lo;
+	else if( lo > 0 && x - m_series.at(lo - 1).x() < m_series.at(lo).x() - x )
+		--lo;
+
+	point = m_series.at(lo);
+	return true;
+}
+
+QVector<QPointF> PlotJob::decimate(int buckets, const std::function<void(int)> &progress) const
+{
+	QMutexLocker locker(&m_mutex);
+	const qint64 size = m_series.size();
+	const int blocks = m_series.blockCount();
+
+	if( size == 0 )
+		return QVector<QPointF>();
+
+	// Короткий ряд прореживать незачем
+	if( size <= 4 * static_cast<qint64>( buckets ) )
+		return m_series.toVector();
+
+	PlotExport::Decimator decimator(m_series.first().x(), m_series.last().x(), buckets);
+	locker.unlock();
+
+	// Блокировка берется на блок, чтобы не задерживать отрисовку
+	for(int b = 0; b < blocks; ++b) {
+		locker.relock();
+
+		if( m_series.size() != size )
+			return QVector<QPointF>();
+
+		decimator.add(m_series.blockData(b), m_series.blockSize(b));
+		locker.unlock();
+
+		if( progress )
+			progress(100 * (b + 1) / blocks);
+	}
+
+	return decimator.finish();
+}
+
+QVector<QPointF> PlotJob::derive(DerivedSeries::Operation operation, int buckets) const
+{
+	QMutexLocker locker(&m_mutex);
+	const qint64 size = m_series.size();
+	const int blocks = m_series.blockCount();
+	const bool resident = m_series.bytesOnDisk() == 0;
+	locker.unlock();
+
+	// Длина проверяется до копирования ряда
+	if( operation == DerivedSeries::Spectrum ) {
+		if( !resident || size > DerivedSeries::spectrumLimit )
+			return QVector<QPointF>();
+
+		return PlotExport::decimate(DerivedSeries::spectrum(series()), buckets);
+	}
+
+	if( !DerivedSeries::Stream::isStreamable(operation) || size < 2 )
+		return QVector<QPointF>();
+
+	locker.relock();
+
+	if( m_series.size() != size )
+		return QVector<QPointF>();
+
+	DerivedSeries::Stream stream(operation, m_series, buckets);
+	locker.unlock();
+
+	// Блокировка берется на блок, как в decimate()
+	for(int b = 0; b < blocks; ++b) {
+		locker.relock();
+
+		if( m_series.size() != size )
+			return QVector<QPointF>();
+
+		const qint64 begin = b * SeriesStore::blockPoints;
+		stream.add(m_series, begin, begin + m_series.blockSize(b));
+		locker.unlock();
+	}
+
+	return stream.finish();
+}
+
+bool PlotJob::normalization(double &xMaxAbs, double &yMaxAbs) const
+{
+	QMutexLocker locker(&m_mutex);
+	xMaxAbs = m_xNorm;
+	yMaxAbs = m_yNorm;
+
+	return m_xNorm > 0 && m_yNorm > 0;
+}
+
+qint64 PlotJob::bytesOnDisk() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_series.bytesOnDisk();
+}
+
+int PlotJob::progress() const
+{
+	QMutexLocker locker(&m_mutex);
+	const double from = m_config.from, to = m_config.to;
+	int percents = 0;
+
+	if( m_config.shared )
+		return 0;
+
+	if( m_series.size() > 0 ) {
+		percents += 0.30 * static_cast<int>( std::ceil(100.0 * (m_series.last().x() - from) / (to - from)) );
+		percents += 0.30 * static_cast<int>( std::ceil(100.0 * m_observedPoints / m_series.size()) );
+		percents += 0.40 * static_cast<int>( std::ceil(100.0 * m_printedPoints / m_series.size()) );
+	}
+	else if( m_previewSize > 0 )
+		percents += 0.30 * static_cast<int>( std::ceil(100.0 * m_previewPoints / m_previewSize) );
+
+	return percents;
+}
+
+qint64 PlotJob::elapsed() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_elapsed;
+}
+
+/* Private */
+
+void PlotJob::run()
+{
+	// Отмененная в очереди задача не начинается
+	if( isCanceled() ) {
+		setState(Canceled);
+		emit finished();
+		return;
+	}
+
+	setState(Running);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// Прогрессивному режиму нужен плотный массив всех значений
+	const bool progressive = m_config.progressive && m_series.isEmpty()
+			&& fitsProgressive(PlotEngine::gridSize(m_config.from, m_config.to, m_step), m_config.budget);
+
+	if( m_config.shared )
+		follow();
+	else if( progressive ) {
+		calculateProgressive();
+		// Предпросмотр остается на экране, пока не готова вся кривая
+		render(true);
+	}
+	else {
+		calculate();
+		findMaxAbs();
+		render();
+	}
+
+	{
+		QMutexLocker locker(&m_mutex);
+		m_elapsed = timer.elapsed();
+	}
+
+	setState(isCanceled() ? Canceled : Finished);
+	emit finished();
+}
+
+void PlotJob::setState(State state)
+{
+	QMutexLocker locker(&m_stateMutex);
+	m_state = state;
+	m_stateChanged.wakeAll();
+}
+
+bool PlotJob::isCanceled() const
+{
+	return static_cast<bool>( m_canceled.loadRelaxed() );
+}
+
+void PlotJob::pauseTest()
+{
+	if( !m_paused.loadRelaxed() )
+		return;
+
+	QMutexLocker locker(&m_pauseMutex);
+	while( m_paused.loadRelaxed() && !isCanceled() )
+		m_resumed.wait(&m_pauseMutex);
+}
+
+double PlotJob::xAt(qint64 i) const
+{
+	return PlotEngine::gridX(m_config.from, m_step, i, m_config.precision);
+}
+
+QPointF PlotJob::pointAt(qint64 i) const
+{
+	if( m_config.precision == PlotPrecision::Extended && m_config.fExtended ) {
+		const long double x = static_cast<long double>(m_config.from) + static_cast<long double>(m_step) * i;
+		return QPointF(static_cast<double>(x), static_cast<double>(m_config.fExtended(x)));
+	}
+
+	const double x = xAt(i);
+	return QPointF(x, m_config.f(x));
+}
+
+void PlotJob::calculate()
+{
+	const qint64 size = PlotEngine::gridSize(m_config.from, m_config.to, m_step);
+	const qint64 currentSize = m_series.size();
+	QVector<QPointF> pointSegment; pointSegment.reserve(segmentSize);
+
+	if( m_config.batch && m_config.precision != PlotPrecision::Extended ) {
+		calculateBatch(size);
+		return;
+	}
+
+	for(qint64 i = currentSize; i < size; ++i) {
+		if( isCanceled() )
+			return;
+
+		pauseTest();
+
+		pointSegment << pointAt(i);
+
+		if( i % segmentSize == 0 || i == size - 1 ) { // Сегмент заполнен
+			QMutexLocker locker(&m_mutex);
+
+			if( !m_series.append(pointSegment) ) {
+				qWarning() << "PlotJob: cannot allocate series storage";
+				return;
+			}
+
+			pointSegment.clear();
+		}
+	}
+}
+
+void PlotJob::calculateBatch(qint64 size)
+{
+	QVector<double> xs(segmentSize), ys(segmentSize);
+	QVector<QPointF> pointSegment;
+
+	for(qint64 first = m_series.size(); first < size; first += segmentSize) {
+		if( isCanceled() )
+			return;
+
+		pauseTest();
+
+		const int n = static_cast<int>( qMin<qint64>(segmentSize, size - first) );
+
+		for(int i = 0; i < n; ++i)
+			xs[i] = xAt(first + i);
+
+		m_config.batch(xs.constData(), ys.data(), n);
+
+		pointSegment.resize(n);
+		for(int i = 0; i < n; ++i)
+			pointSegment[i] = QPointF(xs[i], ys[i]);
+
+		QMutexLocker locker(&m_mutex);
+
+		if( !m_series.append(pointSegment) ) {
+			qWarning() << "PlotJob: cannot allocate series storage";
+			return;
+		}
+	}
+}
+
+void PlotJob::calculateProgressive()
+{
+	const int size = static_cast<int>( PlotEngine::gridSize(m_config.from, m_config.to, m_step) );
+	QVector<double> ys(size);
+	int stride = previewStride;
+	int finest = 0; // Шаг последнего завершенного прохода
+
+	if( size < 1 )
+		return;
+
+	{
+		QMutexLocker locker(&m_mutex);
+		m_previewPoints = 0;
+		m_previewSize = size;
+	}
+
+	yMaxAbs = 0;
+	xMaxAbs = qMax(qAbs(xAt(0)), qAbs(xAt(size - 1)));
+
+	// Последняя точка нужна уже в первом проходе, чтобы
+	// предпросмотр охватывал весь интервал
+	ys[size - 1] = pointAt(size - 1).y();
+	yMaxAbs = qAbs(ys[size - 1]);
+
+	for(; stride >= 1; stride /= 2) {
+		// Первый проход берет каждую stride-ю точку,
+		// последующие - только не вычисленные ранее
+		const int first = stride == previewStride ? 0 : stride;
+		const int increment = stride == previewStride ? stride : 2 * stride;
+
+		for(int i = first; i < size - 1; i += increment) {
+			if( isCanceled() )
+				break;
+
+			pauseTest();
+
+			ys[i] = pointAt(i).y();
+			yMaxAbs = qMax(yMaxAbs, qAbs(ys[i]));
+		}
+
+		if( isCanceled() )
+			break;
+
+		finest = stride;
+		renderPreview(ys, stride);
+	}
+
+	if( finest == 0 )
+		return;
+
+	// При досрочной остановке сохраняется ряд последнего завершенного
+	// прохода, шаг интервала приводится в соответствие с ним.
+	// Ряд переносится в хранилище сегментами, без второй плотной копии
+	QVector<QPointF> pointSegment; pointSegment.reserve(segmentSize);
+	{
+		QMutexLocker locker(&m_mutex);
+		m_series.clear();
+	}
+
+	for(int i = 0; i < size; i += finest) {
+		pointSegment << QPointF(xAt(i), ys[i]);
+
+		if( pointSegment.size() == segmentSize || i + finest >= size ) {
+			QMutexLocker locker(&m_mutex);
+
+			if( !m_series.append(pointSegment) ) {
+				qWarning() << "PlotJob: cannot allocate series storage";
+				return;
+			}
+
+			pointSegment.clear();
+		}
+	}
+
+	/* Последняя точка, если она вне сетки с шагом finest, отбрасывается:
+	 * ряд остается началом новой сетки (m_uniform верно, nearestPoint()
+	 * и продолжение расчета через submit() находят точки по индексу) */
+	QMutexLocker locker(&m_mutex);
+	m_observedPoints = m_series.size();
+	m_previewSize = 0;
+
+	if( finest > 1 )
+		m_step *= finest;
+}
+
+void PlotJob::renderPreview(const QVector<double> &ys, int stride)
+{
+	const int size = ys.size();
+	QImage img = PlotImpl::emptyImage();
+	QPainterPath curve;
+
+	curve.moveTo(xAt(0) / xMaxAbs, ys[0] / yMaxAbs);
+	for(int i = stride; i < size - 1; i += stride)
+		curve.lineTo(xAt(i) / xMaxAbs, ys[i] / yMaxAbs);
+	curve.lineTo(xAt(size - 1) / xMaxAbs, ys[size - 1] / yMaxAbs);
+
+	QPainter p(&img);
+	const int side = img.width();
+	p.translate(side / 2, side / 2);
+	p.scale(side/2, side/2);
+	p.setPen(QPen(Qt::white, 0.005, Qt::SolidLine));
+	p.drawPath(curve);
+	p.end();
+
+	QMutexLocker locker(&m_mutex);
+	m_curve = img;
+	m_dirty = img.rect();
+	m_previewPoints = (size - 1) / stride + 1;
+	m_xNorm = xMaxAbs;
+	m_yNorm = yMaxAbs;
+}
+
+void PlotJob::findMaxAbs()
+{
+	const qint64 size = m_series.size();
+
+	if( size > 0 ) {
+		// Экстремумы берутся из сводок блоков, сам ряд не читается
+		yMaxAbs = 0;
+		xMaxAbs = 0;
+
+		for(int b = 0; b < m_series.blockCount(); ++b) {
+			if( isCanceled() )
+				return;
+
+			yMaxAbs = qMax(yMaxAbs, m_series.summary(b).yMaxAbs);
+		}
+
+		xMaxAbs = qMax(qAbs(m_series.first().x()), qAbs(m_series.last().x()));
+
+		QMutexLocker locker(&m_mutex);
+		m_observedPoints = size;
+		m_xNorm = xMaxAbs;
+		m_yNorm = yMaxAbs;
+	}
+}
+
+void PlotJob::render(bool offscreen)
+{
+	const qint64 size = m_series.size();
+	QImage image; // Задний буфер для offscreen
+
+	if( size > 0) {
+		const QPointF beginPoint = {m_series.first().x() / xMaxAbs, m_series.first().y() / yMaxAbs };
+		QPainterPath curve;
+		QPointF np; // Следующая точка
+
+		curve.moveTo(beginPoint);
+		for(qint64 i = 1; i < size; ++i) {
+			if( isCanceled() )
+				return;
+
+			pauseTest();
+
+			// Нормировка
+			np = m_series.at(i);
+
+			np.setX( np.x() / xMaxAbs );
+			np.setY( np.y() / yMaxAbs );
+
+			curve.lineTo(np);
+
+			if( i % segmentSize == 0 || i == size - 1) {
+				QMutexLocker locker(&m_mutex);
+				QImage &target = offscreen ? image : m_curve;
+
+				if( target.isNull() )
+					target = PlotImpl::emptyImage();
+
+				QPainter p(&target);
+				// Трансформация
+				const int side = target.width();
+				p.translate(side / 2, side / 2);
+				p.scale(side/2, side/2);
+
+				// Отрисовка
+				p.setPen(QPen(Qt::white, 0.005, Qt::SolidLine));
+				p.drawPath(curve);
+
+				if( !offscreen ) // Запас на толщину пера
+					m_dirty |= p.transform().mapRect(curve.controlPointRect()).toAlignedRect().adjusted(-2, -2, 2, 2);
+
+				m_printedPoints = i;
+				locker.unlock();
+
+				curve.clear();
+				curve.moveTo(np); //should be?
+			}
+		}
+
+		if( offscreen ) {
+			QMutexLocker locker(&m_mutex);
+			m_curve = image;
+			m_dirty = image.rect();
+		}
+	}
+}
+
+void PlotJob::follow()
+{
+	const SharedSeriesReader &reader = *m_config.shared;
+	// Запас кольца на случай, если писатель обгонит отрисовку кадра
+	const quint64 window = reader.capacity() - reader.capacity() / 4;
+	quint64 drawn = 0;
+
+	while( !isCanceled() ) {
+		pauseTest();
+
+		const quint64 written = reader.written();
+
+		if( written != drawn ) {
+			const quint64 first = written > window ? written - window : 0;
+
+			// Кадр, часть которого перезаписана во время чтения, отбрасывается
+			if( renderShared(first, written) )
+				drawn = written;
+		}
+
+		QThread::msleep(followInterval);
+	}
+}
+
+bool PlotJob::renderShared(quint64 first, quint64 last)
+{
+	const SharedSeriesReader &reader = *m_config.shared;
+
+	if( last - first < 2 )
+		return false;
+
+	// Нормировка по окну, точки читаются прямо из разделяемой памяти
+	double yMax = 0;
+	for(quint64 i = first; i < last; ++i) {
+		const double y = qAbs(reader.at(i).y());
+		if( qIsFinite(y) )
+			yMax = qMax(yMax, y);
+	}
+
+	const double xMax = qMax(qAbs(reader.at(first).x()), qAbs(reader.at(last - 1).x()));
+
+	if( !(xMax > 0) || !(yMax > 0) || !qIsFinite(xMax) || !reader.isIntact(first) )
+		return false;
+
+	/* Прореживание M4: в каждом столбце пикселей остаются первая,
+	 * крайние по y и последняя точки, порядок их следования сохраняется */
+	QImage img = PlotImpl::emptyImage();
+	const int side = img.width();
+	QPainterPath curve;
+	QPointF column[4];	// first, min, max, last
+	quint64 index[4] = {};
+	int current = std::numeric_limits<int>::min();
+
+	auto flush = [&]() {
+		if( current == std::numeric_limits<int>::min() )
+			return;
+
+		int order[] = {0, 1, 2, 3};
+		if( index[2] < index[1] )
+			qSwap(order[1], order[2]);
+
+		for(int k: order) {
+			const QPointF p(column[k].x() / xMax, column[k].y() / yMax);
+			if( curve.elementCount() == 0 )
+				curve.moveTo(p);
+			else
+				curve.lineTo(p);
+		}
+	};
+
+	for(quint64 i = first; i < last; ++i) {
+		const QPointF p = reader.at(i);
+
+		if( !qIsFinite(p.x()) )
+			continue;
+
+		const int c = static_cast<int>( std::floor((p.x() / xMax + 1) * side / 2) );
+
+		if( c != current ) {
+			flush();
+			current = c;
+			column[0] = column[1] = column[2] = p;
+			index[0] = index[1] = index[2] = i;
+		}
+		else if( p.y() < column[1].y() ) {
+			column[1] = p;
+			index[1] = i;
+		}
+		else if( p.y() > column[2].y() ) {
+			column[2] = p;
+			index[2] = i;
+		}
+
+		column[3] = p;
+		index[3] = i;
+	}
+	flush();
+
+	if( !reader.isIntact(first) )
+		return false;
+
+	QPainter p(&img);
+	p.translate(side / 2, side / 2);
+	p.scale(side/2, side/2);
+	p.setPen(QPen(Qt::white, 0.005, Qt::SolidLine));
+	p.drawPath(curve);
+	p.end();
+
+	QMutexLocker locker(&m_mutex);
+	m_curve = img;
+	m_dirty = img.rect();
+	m_xNorm = xMax;
+	m_yNorm = yMax;
+
+	return true;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QVector>
+#include <QPointF>
+#include <QImage>
+#include <QRect>
+#include <functional>
+#include <climits>
+#include "plotengine_global.h"
+#include "functions.h"
+#include "seriesstore.h"
+#include "derivedseries.h"
+
+class QThreadPool;
+class PlotJob;
+class SharedSeriesReader;
+
+// Задача живет, пока на нее есть ссылки, в том числе у исполнителя
+using PlotJobHandle = QSharedPointer<PlotJob>;
+
+/* Параметры запуска, копируются в задачу при ее создании,
+ * поэтому их изменение не затрагивает уже идущий расчет */
+struct PlotJobConfig
+{
+	std::function<double(double)> f;
+	// Необязательная версия функции для PlotPrecision::Extended
+	std::function<long double(long double)> fExtended;
+	// Необязательный специализированный пакет, см. PlotFunctions::Batch
+	PlotFunctions::Batch batch;
+	/* Ряд другого процесса в разделяемой памяти: вместо расчета задача
+	 * до отмены отрисовывает его окно по мере поступления точек */
+	QSharedPointer<const SharedSeriesReader> shared;
+	PlotPrecision precision = PlotPrecision::Double;
+	double from = 0, to = 0, step = 0;
+	bool progressive = false;
+	qint64 budget = 0;		// Бюджет ОЗУ для ряда, см. SeriesStore
+	int priority = 0;		// Приоритет в очереди исполнителя
+};
+
+/* Один запуск расчета: вычисление ряда, нормировка и отрисовка кривой.
+ * Все результаты задача хранит сама, поэтому новая задача может сразу
+ * заменить старую, не дожидаясь ее остановки. Выполняется в общем
+ * пуле потоков executor(), слежение за разделяемой памятью - в своем потоке */
+class PLOTENGINE_EXPORT PlotJob: public QObject, public QEnableSharedFromThis<PlotJob>
+{
+	Q_OBJECT
+public:
+	enum State { Idle, Queued, Running, Finished, Canceled };
+
+	static PlotJobHandle create(const PlotJobConfig &);
+	// Общий для всех графиков исполнитель
+	static QThreadPool *executor();
+	/* Помещается ли сетка из points точек в прогрессивный режим при бюджете
+	 * budget (0 - без ограничения): в ОЗУ одновременно плотный массив y
+	 * и сам ряд, 24 байта на точку */
+	static bool fitsProgressive(qint64 points, qint64 budget);
+	/* Только ряд, в вызывающем потоке и тем же циклом, что в run(),
+	 * без нормировки и отрисовки. Пуст, если ряд не помещается в QVector */
+	static QVector<QPointF> compute(const PlotJobConfig &);
+
+	// Ставит задачу в очередь исполнителя с приоритетом config().priority,
+	// задача с config().shared сразу получает отдельный поток
+	void start();
+	// Останавливает задачу, в том числе приостановленную или ждущую в очереди
+	void cancel();
+	void pause(bool state);
+	bool isPaused() const;
+
+	State state() const;
+	// Задача в очереди или выполняется
+	bool isActive() const;
+	// Ожидает завершения или отмены, false - по истечении msecs
+	bool wait(unsigned long msecs = ULONG_MAX);
+
+	/* Продолжение вызывается в потоке, создавшем задачу (обычно GUI),
+	 * после ее успешного завершения, при отмене не вызывается */
+	void then(const std::function<void()> &continuation);
+
+	const PlotJobConfig &config() const;
+	// Шаг сетки готового ряда, после досрочной остановки прогрессивного режима он крупнее исходного
+	double step() const;
+
+	// Начальные точки ряда, расчет продолжается с их конца
+	void setSeries(const QVector<QPointF> &);
+	// То же без копирования: ряд неактивной задачи source переходит к этой
+	void takeSeries(PlotJob &source);
+	// Копия ряда, пустая для неразмещаемого в ОЗУ (см. isResident())
+	QVector<QPointF> series() const;
+	bool isEmpty() const;
+	// Ряд целиком в ОЗУ и помещается в QVector, его копия не превысит бюджет
+	bool isResident() const;
+
+	QImage curve() const;
+	// Область curve(), измененная с прошлого вызова
+	QRect takeDirtyRect();
+
+	// Ближайшая по x точка ряда без его копирования
+	bool nearestPoint(double x, QPointF &point) const;
+	/* Ряд, прореженный до buckets столбцов (см. PlotExport::Decimator),
+	 * читается поблочно, в том числе вытесненный на диск. Пуст, если ряд
+	 * пуст или забран другой задачей во время обхода */
+	QVector<QPointF> decimate(int buckets, const std::function<void(int percent)> &progress = nullptr) const;
+	/* Производный ряд (см. DerivedSeries::Stream), прореженный до buckets
+	 * столбцов, считается по блокам хранилища так же, как decimate().
+	 * Спектр - только для размещенного в ОЗУ ряда не длиннее
+	 * DerivedSeries::spectrumLimit. Пуст, если посчитать нельзя */
+	QVector<QPointF> derive(DerivedSeries::Operation, int buckets) const;
+	// Коэффициенты нормировки текущей кривой
+	bool normalization(double &xMaxAbs, double &yMaxAbs) const;
+
+	qint64 bytesOnDisk() const;
+	int progress() const;
+	// Длительность выполнения, мс
+	qint64 elapsed() const;
+
+signals:
+	// Испускается и при отмене
+	void finished();
+
+private:
+	explicit PlotJob(const PlotJobConfig &);
+	void run();
+	void setState(State);
+	bool isCanceled() const;
+	void pauseTest();
+	double xAt(qint64 i) const;
+	QPointF pointAt(qint64 i) const;
+	void calculate();
+	void calculateBatch(qint64 size);
+	void calculateProgressive();
+	void renderPreview(const QVector<double> &, int stride);
+	void findMaxAbs();
+	void render(bool offscreen = false);
+	void follow();
+	bool renderShared(quint64 first, quint64 last);
+
+	friend class PlotJobRunner;
+
+private:
+	const PlotJobConfig m_config;
+	double m_step;
+	double yMaxAbs = 0, xMaxAbs = 0;
+
+	QAtomicInt m_canceled = 0;
+	QAtomicInt m_paused = 0;
+	QMutex m_pauseMutex;
+	QWaitCondition m_resumed;
+
+	mutable QMutex m_stateMutex;
+	QWaitCondition m_stateChanged;
+	State m_state = Idle;
+
+	/* Обработанные точки добавляются пакетом,
+	 * рамзер которого определяет segmentSize */
+	const int segmentSize = 500;
+	/* Шаг первого (самого грубого) прохода прогрессивного режима */
+	const int previewStride = 1024;
+	/* Период опроса разделяемой памяти, мс */
+	const int followInterval = 40;
+
+	mutable QMutex m_mutex;		// Защищает доступ к определенным ниже полям
+	SeriesStore m_series;
+	QImage m_curve;
+	QRect m_dirty;
+	qint64 m_printedPoints = 0;	// Добавлено на m_curves
+	qint64 m_observedPoints = 0;	// Нормировано
+	int m_previewPoints = 0;	// Обсчитано в прогрессивном режиме
+	int m_previewSize = 0;		// из общего числа точек
+	double m_xNorm = 0, m_yNorm = 0;	// Нормировка, по которой отрисована m_curve
+	bool m_uniform = true;		// x[i] = xAt(i)
+	qint64 m_elapsed = 0;
+};
@@ -0,0 +1,268 @@
+#include "plotreplay.h"
+#include "plotimpl.h"
+#include "plotjob.h"
+#include "functions.h"
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+
+namespace
+{
+
+// Допустимая доля несовпадающих пикселей
+const double maxDifference = 0.001;
+
+}
+
+QString PlotReplay::Config::name() const
+{
+	return QString("f%1_A%2_B%3_C%4_%5_%6_%7")
+			.arg(function).arg(A).arg(B).arg(C).arg(from).arg(to).arg(step);
+}
+
+QVector<PlotReplay::Config> PlotReplay::loadCorpus(const QString &fileName, QString *error)
+{
+	QVector<Config> corpus;
+	QFile ifile(fileName);
+
+	if( !ifile.open(QFile::ReadOnly | QFile::Text) ) {
+		if( error )
+			*error = ifile.errorString();
+		return corpus;
+	}
+
+	QTextStream stream(&ifile);
+	while( !stream.atEnd() ) {
+		QString line = stream.readLine().section('#', 0, 0).trimmed();
+
+		if( line.isEmpty() )
+			continue;
+
+		QTextStream fields(&line, QIODevice::ReadOnly);
+		Config config;
+		fields >> config.function >> config.A >> config.B >> config.C
+			   >> config.from >> config.to >> config.step;
+
+		if( fields.status() != QTextStream::Ok
+				|| config.function < 0 || config.function >= PlotFunctions::count() || config.step <= 0 ) {
+			if( error )
+				*error = QString("Bad corpus line: %1").arg(line);
+			return QVector<Config>();
+		}
+
+		corpus << config;
+	}
+
+	return corpus;
+}
+
+PlotReplay::Result PlotReplay::run(const Config &config)
+{
+	PlotImpl impl(nullptr);
+
+	impl.setFunction(PlotFunctions::make(config.function, config.A, config.B, config.C),
+					 PlotFunctions::names().value(config.function));
+	impl.setFunctionBatch(PlotFunctions::makeBatch(config.function, config.A, config.B, config.C));
+	impl.setParams(config.A, config.B, config.C);
+	impl.setInterval(config.from, config.to, config.step);
+
+	// Без таймера обновления порядок вычислений и отрисовки
+	// полностью определен, задача просто дожидается
+	impl.submit()->wait();
+
+	const auto series = impl.series();
+	Result result;
+	result.checksum = QCryptographicHash::hash(
+				QByteArray::fromRawData(reinterpret_cast<const char *>(series.constData()),
+										series.size() * static_cast<int>( sizeof(QPointF) )),
+				QCryptographicHash::Sha1).toHex();
+	result.curve = impl.curve();
+	result.elapsed = impl.elapsed();
+
+	return result;
+}
+
+double PlotReplay::difference(const QImage &a, const QImage &b, int tolerance)
+{
+	if( a.size() != b.size() )
+		return 1.0;
+
+	if( a.isNull() )
+		return 0.0;
+
+	const QImage x = a.convertToFormat(QImage::Format_RGBA8888);
+	const QImage y = b.convertToFormat(QImage::Format_RGBA8888);
+	qint64 differs = 0;
+
+	for(int row = 0; row < x.height(); ++row) {
+		const uchar *px = x.constScanLine(row);
+		const uchar *py = y.constScanLine(row);
+
+		for(int col = 0; col < x.width(); ++col, px += 4, py += 4) {
+			for(int c = 0; c < 4; ++c) {
+				if( qAbs(px[c] - py[c]) > tolerance ) {
+					++differs;
+					break;
+				}
+			}
+		}
+	}
+
+	return static_cast<double>( differs ) / (static_cast<qint64>( x.width() ) * x.height());
+}
+
+int PlotReplay::replay(const QString &corpusFile, const QString &goldenDir, bool update, QTextStream &out)
+{
+	QString error;
+	const auto corpus = loadCorpus(corpusFile, &error);
+
+	if( !error.isEmpty() ) {
+		out << error << '\n';
+		return 1;
+	}
+
+	QDir dir(goldenDir);
+	if( !dir.exists() && !QDir().mkpath(goldenDir) ) {
+		out << "Cannot create " << goldenDir << '\n';
+		return 1;
+	}
+
+	// Замеры времени пишутся рядом с эталонами
+	QFile timings(dir.filePath("timings.csv"));
+	if( !timings.open(QFile::WriteOnly | QFile::Truncate | QFile::Text) ) {
+		out << "Cannot write " << timings.fileName() << ": " << timings.errorString() << '\n';
+		return 1;
+	}
+
+	QTextStream csv(&timings);
+	csv << "name,elapsed_ms,checksum,difference,status" << '\n';
+
+	int failures = 0;
+
+	for(const auto &config: corpus) {
+		const QString name = config.name();
+		const Result result = run(config);
+		const QString imageFile = dir.filePath(name + ".png");
+		const QString sumFile = dir.filePath(name + ".sha1");
+		QString status = "OK";
+		double diff = 0;
+
+		if( update ) {
+			QFile sum(sumFile);
+			if( !result.curve.save(imageFile) || !sum.open(QFile::WriteOnly | QFile::Truncate) ) {
+				status = "WRITE ERROR";
+				++failures;
+			}
+			else {
+				sum.write(result.checksum);
+				status = "UPDATED";
+			}
+		}
+		else {
+			QFile sum(sumFile);
+
+			if( !sum.open(QFile::ReadOnly) ) {
+				status = "NO GOLDEN";
+				++failures;
+			}
+			else {
+				const QImage golden(imageFile);
+
+				if( !golden.isNull() )
+					diff = difference(result.curve, golden);
+
+				if( sum.readAll().trimmed() != result.checksum )
+					status = "SERIES DIFFERS";
+				else if( golden.isNull() )
+					status = "NO IMAGE GOLDEN";
+				else if( diff > maxDifference )
+					status = "IMAGE DIFFERS";
+
+				if( status != "OK" )
+					++failures;
+			}
+		}
+
+		out << name << ": " << status << ", " << result.elapsed << " ms\n";
+		out.flush();
+		csv << name << ',' << result.elapsed << ',' << result.checksum << ',' << diff << ',' << status << '\n';
+	}
+
+	return failures;
+}
+
+void PlotReplay::benchmark(int points, QTextStream &out)
+{
+	// Пакеты того же размера, что и в PlotJob::calculate()
+	const int segment = 500;
+	const QStringList names = PlotFunctions::names();
+	QVector<double> xs(points), ys(points);
+
+	// x > 0, чтобы log был определен
+	for(int i = 0; i < points; ++i)
+		xs[i] = 1.0 + 1e-6 * i;
+
+	out << "function,std_function_ms,batch_ms,speedup" << '\n';
+
+	for(int k = 0; k < names.size(); ++k) {
+		const auto f = PlotFunctions::make(k, 2, 3, 4);
+		const auto batch = PlotFunctions::makeBatch(k, 2, 3, 4);
+		qint64 generic = 0, specialized = 0;
+
+		// Первый проход прогревает кэши, засчитывается лучший из двух
+		for(int pass = 0; pass < 2; ++pass) {
+			QElapsedTimer timer;
+
+			timer.start();
+			for(int i = 0; i < points; ++i)
+				ys[i] = f(xs[i]);
+			const qint64 g = timer.nsecsElapsed();
+
+			timer.restart();
+			for(int first = 0; first < points; first += segment)
+				batch(xs.constData() + first, ys.data() + first, qMin(segment, points - first));
+			const qint64 s = timer.nsecsElapsed();
+
+			generic = pass == 0 ? g : qMin(generic, g);
+			specialized = pass == 0 ? s : qMin(specialized, s);
+		}
+
+		out << '"' << names[k] << '"' << ',' << generic / 1e6 << ',' << specialized / 1e6 << ','
+			<< (specialized > 0 ? double(generic) / specialized : 0.0) << '\n';
+	}
+
+	// Цена точности: весь расчет ряда циклом PlotJob на той же сетке
+	out << '\n' << "function,double_ms,compensated_ms,extended_ms" << '\n';
+
+	for(int k = 0; k < names.size(); ++k) {
+		PlotJobConfig config;
+		config.f = PlotFunctions::make(k, 2, 3, 4);
+		config.fExtended = PlotFunctions::makeExtended(k, 2, 3, 4);
+		config.batch = PlotFunctions::makeBatch(k, 2, 3, 4);
+		config.from = xs.first();
+		config.step = 1e-6;
+		config.to = config.from + config.step * (points - 1);
+
+		out << '"' << names[k] << '"';
+
+		for(auto precision: {PlotPrecision::Double, PlotPrecision::Compensated, PlotPrecision::Extended}) {
+			config.precision = precision;
+			qint64 best = 0;
+
+			for(int pass = 0; pass < 2; ++pass) {
+				QElapsedTimer timer;
+				timer.start();
+				PlotJob::compute(config);
+				const qint64 t = timer.nsecsElapsed();
+
+				best = pass == 0 ? t : qMin(best, t);
+			}
+
+			out << ',' << best / 1e6;
+		}
+
+		out << '\n';
+	}
+}
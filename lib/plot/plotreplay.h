@@ -0,0 +1,49 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+
+class QTextStream;
+
+/* Воспроизведение расчетов без GUI и сравнение с эталонами.
+ * Ряд сверяется по контрольной сумме, кривая - попиксельно с допуском */
+namespace PlotReplay
+{
+	struct PLOTENGINE_EXPORT Config
+	{
+		int function = 0;	// Индекс в PlotFunctions::names()
+		double A = 0, B = 0, C = 0;
+		double from = 0, to = 0, step = 0;
+
+		QString name() const;
+	};
+
+	struct Result
+	{
+		QByteArray checksum;	// SHA-1 точек ряда
+		QImage curve;
+		qint64 elapsed = 0;		// мс
+	};
+
+	/* Строки вида "function A B C from to step", # - комментарий */
+	PLOTENGINE_EXPORT QVector<Config> loadCorpus(const QString &fileName, QString *error = nullptr);
+
+	PLOTENGINE_EXPORT Result run(const Config &);
+
+	// Доля пикселей, отличающихся больше чем на tolerance по любому каналу
+	PLOTENGINE_EXPORT double difference(const QImage &, const QImage &, int tolerance = 8);
+
+	/* Прогоняет корпус и сравнивает с эталонами из goldenDir
+	 * (update - перезаписать эталоны). Обязательны оба эталона: ряд <name>.sha1
+	 * и кривая <name>.png. Возвращает число расхождений, отсутствующий или
+	 * нечитаемый эталон тоже считается расхождением */
+	PLOTENGINE_EXPORT int replay(const QString &corpusFile, const QString &goldenDir, bool update, QTextStream &out);
+
+	/* Время вычисления points значений каждой встроенной функции через
+	 * std::function и через специализированный пакет, затем время расчета
+	 * ряда в каждом режиме PlotPrecision; две таблицы CSV в out */
+	PLOTENGINE_EXPORT void benchmark(int points, QTextStream &out);
+}
@@ -0,0 +1,268 @@
+#include "plotsweep.h"
+#include "plotimpl.h"
+#include "plotengine.h"
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <cmath>
+#include <limits>
+
+double SweepRange::value(int i) const
+{
+	if( count <= 1 )
+		return from;
+
+	return from + (to - from) * i / (count - 1);
+}
+
+PlotSweep::PlotSweep(QObject *parent)
+	: QThread (parent)
+{ }
+
+void PlotSweep::setKernel(const PlotFunctions::Kernel &kernel, const QString &name)
+{
+	m_kernel = kernel;
+	m_fName = name;
+}
+
+QString PlotSweep::functionName() const
+{
+	return m_fName;
+}
+
+void PlotSweep::setRanges(const SweepRange &A, const SweepRange &B, const SweepRange &C)
+{
+	m_A = A;
+	m_B = B;
+	m_C = C;
+}
+
+void PlotSweep::setInterval(double from, double to, double step)
+{
+	m_from = from;
+	m_to = to;
+	m_step = step;
+}
+
+void PlotSweep::getInterval(double &from, double &to, double &step) const
+{
+	from = m_from;
+	to = m_to;
+	step = m_step;
+}
+
+void PlotSweep::setThumbnailSide(int side)
+{
+	m_thumbnailSide = side;
+}
+
+int PlotSweep::combinations() const
+{
+	return qMax(1, m_A.count) * qMax(1, m_B.count) * qMax(1, m_C.count);
+}
+
+qint64 PlotSweep::estimateMemory() const
+{
+	const qint64 points = PlotEngine::gridSize(m_from, m_to, m_step);
+	const qint64 side = m_thumbnailSide;
+
+	return points * static_cast<qint64>( sizeof(double) ) * (1 + m_kernel.basisSize)
+		+ points * static_cast<qint64>( sizeof(QPointF) ) * QThreadPool::globalInstance()->maxThreadCount()
+		+ combinations() * side * side * 4;
+}
+
+QVector<SweepResult> PlotSweep::results() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_results;
+}
+
+QVector<QPointF> PlotSweep::series(double A, double B, double C) const
+{
+	const qint64 total = PlotEngine::gridSize(m_from, m_to, m_step);
+	QVector<QPointF> series;
+
+	if( total < 1 || total > std::numeric_limits<int>::max() )
+		return series;
+
+	// Базис одной точки, общий базис перебора к этому времени освобожден
+	QVector<double> basis(qMax(1, m_kernel.basisSize));
+	const int size = static_cast<int>( total );
+
+	series.resize(size);
+	for(int i = 0; i < size; ++i) {
+		const double x = m_from + m_step * i;
+		m_kernel.basis(x, basis.data());
+		series[i] = QPointF(x, m_kernel.combine(x, basis.constData(), A, B, C));
+	}
+
+	return series;
+}
+
+QFuture<QString> PlotSweep::exportTo(const QString &dirName, const PlotExport::Progress &progress)
+{
+	const auto results = this->results();
+	m_exportCanceled.storeRelaxed(0);
+
+	return QtConcurrent::run([this, results, dirName, progress]()
+	{
+		const QDir dir(dirName);
+		PlotEngine::Record record;
+		record.function = m_fName;
+		getInterval(record.from, record.to, record.step);
+
+		for(int i = 0; i < results.size(); ++i) {
+			if( m_exportCanceled.loadRelaxed() )
+				return QString();
+
+			const auto &r = results[i];
+			const QString baseName = QString("sweep_A%1_B%2_C%3").arg(r.A).arg(r.B).arg(r.C);
+			QFile ofile(dir.filePath(baseName + ".dat"));
+
+			if( !ofile.open(QFile::WriteOnly | QFile::Truncate) )
+				return ofile.errorString();
+
+			QDataStream stream(&ofile);
+			record.A = r.A;
+			record.B = r.B;
+			record.C = r.C;
+			record.series = series(r.A, r.B, r.C);
+			PlotEngine::write(stream, record);
+			ofile.close();
+
+			const QString imageFile = dir.filePath(baseName + ".png");
+			if( !PlotEngine::renderImage(r.curve, QSize(512, 512)).save(imageFile) )
+				return QString("Cannot write %1").arg(imageFile);
+
+			if( progress )
+				progress(100 * (i + 1) / results.size());
+		}
+
+		return QString();
+	});
+}
+
+void PlotSweep::cancelExport()
+{
+	m_exportCanceled.storeRelaxed(1);
+}
+
+int PlotSweep::progress() const
+{
+	return 100 * m_finished.loadRelaxed() / combinations();
+}
+
+/* Private */
+
+void PlotSweep::run()
+{
+	// Результаты прошлого запуска не доживают до нового, даже прерванного
+	{
+		QMutexLocker locker(&m_mutex);
+		m_results.clear();
+	}
+
+	QVector<SweepResult> results;
+	results.reserve(combinations());
+
+	for(int a = 0; a < qMax(1, m_A.count); ++a)
+		for(int b = 0; b < qMax(1, m_B.count); ++b)
+			for(int c = 0; c < qMax(1, m_C.count); ++c) {
+				SweepResult r;
+				r.A = m_A.value(a);
+				r.B = m_B.value(b);
+				r.C = m_C.value(c);
+				results << r;
+			}
+
+	m_finished.storeRelaxed(0);
+
+	if( !calculateBasis() ) {
+		m_x.clear();
+		m_basis.clear();
+		return;
+	}
+
+	QtConcurrent::blockingMap(results, [this](SweepResult &r)
+	{
+		if( isInterruptionRequested() )
+			return;
+
+		// Ряд живет только до отрисовки миниатюры
+		const auto series = calculate(r);
+
+		if( isInterruptionRequested() )
+			return;
+
+		r.curve = PlotImpl::renderSeries(series, m_thumbnailSide);
+		m_finished.fetchAndAddRelaxed(1);
+	});
+
+	m_x.clear();
+	m_basis.clear();
+
+	if( isInterruptionRequested() )
+		return;
+
+	{
+		QMutexLocker locker(&m_mutex);
+		m_results = results;
+	}
+
+	emit resultReady();
+}
+
+bool PlotSweep::calculateBasis()
+{
+	const int size = static_cast<int>( qMin<qint64>(PlotEngine::gridSize(m_from, m_to, m_step),
+													std::numeric_limits<int>::max() / qMax(1, m_kernel.basisSize)) );
+	const int bs = m_kernel.basisSize;
+
+	m_x.resize(size);
+	m_basis.resize(size * bs);
+
+	// Базис считается блоками, чтобы распараллелить и его
+	const int blockSize = 4096;
+	QVector<int> blocks;
+	for(int i = 0; i < size; i += blockSize)
+		blocks << i;
+
+	double *x = m_x.data();
+	double *basis = m_basis.data();
+
+	QtConcurrent::blockingMap(blocks, [=](int begin)
+	{
+		// Оставшиеся блоки пропускаются, каждый короткий
+		if( isInterruptionRequested() )
+			return;
+
+		const int end = qMin(begin + blockSize, size);
+		for(int i = begin; i < end; ++i) {
+			x[i] = m_from + m_step * i;
+			m_kernel.basis(x[i], basis + i * bs);
+		}
+	});
+
+	return !isInterruptionRequested();
+}
+
+QVector<QPointF> PlotSweep::calculate(const SweepResult &r) const
+{
+	const int size = m_x.size();
+	const int bs = m_kernel.basisSize;
+	const double *x = m_x.constData();
+	const double *basis = m_basis.constData();
+	QVector<QPointF> series(size);
+
+	for(int i = 0; i < size; ++i) {
+		if( i % 4096 == 0 && isInterruptionRequested() )
+			break;
+
+		series[i] = QPointF(x[i], m_kernel.combine(x[i], basis + i * bs, r.A, r.B, r.C));
+	}
+
+	return series;
+}
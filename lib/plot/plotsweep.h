@@ -0,0 +1,88 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include "functions.h"
+#include "plotexport.h"
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QPointF>
+#include <QImage>
+#include <QAtomicInt>
+#include <QFuture>
+
+/* Диапазон значений параметра: count точек от from до to включительно */
+struct PLOTENGINE_EXPORT SweepRange
+{
+	double from, to;
+	int count;
+
+	double value(int i) const;
+};
+
+/* Ряды комбинаций не хранятся: он нужен только для миниатюры,
+ * для экспорта ряд считается заново, см. PlotSweep::exportTo() */
+struct SweepResult
+{
+	double A = 0, B = 0, C = 0;
+	QImage curve;	// Миниатюра кривой, см. PlotImpl::renderSeries
+};
+
+/* Перебор всех комбинаций параметров A, B, C. Сетка x и не зависящие
+ * от параметров подвыражения вычисляются один раз, комбинации
+ * обсчитываются параллельно на всех ядрах */
+class PLOTENGINE_EXPORT PlotSweep: public QThread
+{
+	Q_OBJECT
+public:
+	explicit PlotSweep(QObject *parent = nullptr);
+
+	void setKernel(const PlotFunctions::Kernel &, const QString &);
+	QString functionName() const;
+
+	void setRanges(const SweepRange &A, const SweepRange &B, const SweepRange &C);
+	void setInterval(double from, double to, double step);
+	void getInterval(double &from, double &to, double &step) const;
+	void setThumbnailSide(int);
+
+	int combinations() const;
+	// Память на перебор: сетка с базисом, ряды в работе и миниатюры, байт
+	qint64 estimateMemory() const;
+	QVector<SweepResult> results() const;
+	// Ряд одной комбинации, вычисляется заново
+	QVector<QPointF> series(double A, double B, double C) const;
+
+	/* Экспорт результатов в каталог dirName в общем пуле потоков: ряд
+	 * каждой комбинации считается заново и пишется в .dat, миниатюра - в .png.
+	 * Результат - текст ошибки, пустой при успехе и после cancelExport() */
+	QFuture<QString> exportTo(const QString &dirName, const PlotExport::Progress & = PlotExport::Progress());
+	void cancelExport();
+
+	int progress() const;
+
+signals:
+	void resultReady();
+
+private:
+	void run() override;
+	// false, если перебор прерван
+	bool calculateBasis();
+	QVector<QPointF> calculate(const SweepResult &) const;
+
+private:
+	PlotFunctions::Kernel m_kernel;
+	QString m_fName;
+	SweepRange m_A = {0, 0, 1}, m_B = {0, 0, 1}, m_C = {0, 0, 1};
+	double m_from = 0, m_to = 0, m_step = 0;
+	int m_thumbnailSide = 128;
+
+	/* Общие для всех комбинаций данные */
+	QVector<double> m_x;
+	QVector<double> m_basis;	// m_kernel.basisSize значений на каждую точку
+
+	QAtomicInt m_finished = 0;
+	QAtomicInt m_exportCanceled = 0;
+
+	mutable QMutex m_mutex;		// Защищает m_results
+	QVector<SweepResult> m_results;
+};
@@ -0,0 +1,193 @@
+#include "seriesstore.h"
+#include <QDir>
+#include <QStorageInfo>
+#include <limits>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+SeriesStore::SeriesStore() = default;
+
+SeriesStore::~SeriesStore()
+{
+	clear();
+}
+
+void SeriesStore::setBudget(qint64 bytes)
+{
+	m_budget = bytes;
+}
+
+qint64 SeriesStore::budget() const
+{
+	return m_budget;
+}
+
+qint64 SeriesStore::bytesOnDisk() const
+{
+	return m_diskBlocks * blockPoints * static_cast<qint64>( sizeof(QPointF) );
+}
+
+bool SeriesStore::append(const QPointF *points, qint64 count)
+{
+	while( count > 0 ) {
+		if( m_blocks.isEmpty() || m_blocks.last().count == blockPoints )
+			if( !addBlock() )
+				return false;
+
+		Block &block = m_blocks.last();
+		const qint64 n = qMin(count, blockPoints - block.count);
+
+		if( !block.mapped && block.ram.size() < block.count + n )
+			growBlock(block, block.count + n);
+
+		memcpy(block.data + block.count, points, n * sizeof(QPointF));
+
+		// Сводка считается по ходу добавления, как в PlotImpl::findMaxAbs()
+		Summary &s = block.summary;
+		for(qint64 i = 0; i < n; ++i) {
+			const double y = points[i].y();
+
+			if( block.count == 0 && i == 0 )
+				s.yMin = s.yMax = y;
+
+			s.yMin = qMin(s.yMin, y);
+			s.yMax = qMax(s.yMax, y);
+			s.yMaxAbs = qMax(s.yMaxAbs, qAbs(y));
+		}
+
+		block.count += n;
+		m_size += n;
+		points += n;
+		count -= n;
+	}
+
+	return true;
+}
+
+bool SeriesStore::append(const QVector<QPointF> &points)
+{
+	return append(points.constData(), points.size());
+}
+
+void SeriesStore::clear()
+{
+	for(auto &block: m_blocks)
+		if( block.mapped )
+			m_file->unmap(block.mapped);
+
+	m_blocks.clear();
+	m_size = 0;
+	m_diskBlocks = 0;
+
+	if( m_file && m_file->isOpen() )
+		m_file->resize(0);
+}
+
+void SeriesStore::swap(SeriesStore &other)
+{
+	// Отображения принадлежат файлу и переходят вместе с ним
+	qSwap(m_size, other.m_size);
+	m_blocks.swap(other.m_blocks);
+	qSwap(m_diskBlocks, other.m_diskBlocks);
+	m_file.swap(other.m_file);
+}
+
+QVector<QPointF> SeriesStore::toVector() const
+{
+	if( m_size > std::numeric_limits<int>::max() )
+		return QVector<QPointF>();
+
+	QVector<QPointF> result(static_cast<int>( m_size ));
+	qint64 offset = 0;
+
+	for(const auto &block: m_blocks) {
+		memcpy(result.data() + offset, block.data, block.count * sizeof(QPointF));
+		offset += block.count;
+	}
+
+	return result;
+}
+
+qint64 SeriesStore::estimate(qint64 points)
+{
+	const qint64 limit = std::numeric_limits<qint64>::max();
+
+	// Насыщение вместо переполнения, иначе проверки бюджета пропустили бы огромный ряд
+	if( points > limit / static_cast<qint64>( sizeof(QPointF) ) )
+		return limit;
+
+	return qMax<qint64>(0, points) * static_cast<qint64>( sizeof(QPointF) );
+}
+
+qint64 SeriesStore::availableDisk()
+{
+	return QStorageInfo(QDir::tempPath()).bytesAvailable();
+}
+
+/* Private */
+
+bool SeriesStore::addBlock()
+{
+	const qint64 blockBytes = estimate(blockPoints);
+	const qint64 ramBytes = (m_blocks.size() - m_diskBlocks + 1) * blockBytes;
+	Block block;
+
+	// Блок в ОЗУ растет по мере заполнения, см. growBlock(),
+	// сверх бюджета блоки добавляются в конец временного файла
+	if( m_budget > 0 && ramBytes > m_budget ) {
+		if( !m_file )
+			m_file.reset(new QTemporaryFile(QDir::temp().filePath("simple-plot-XXXXXX.series")));
+
+		if( !m_file->isOpen() && !m_file->open() )
+			return false;
+
+		const qint64 offset = m_diskBlocks * blockBytes;
+
+		if( !reserve(offset, blockBytes) )
+			return false;
+
+		block.mapped = m_file->map(offset, blockBytes);
+
+		if( !block.mapped )
+			return false;
+
+		block.data = reinterpret_cast<QPointF *>( block.mapped );
+		++m_diskBlocks;
+	}
+
+	m_blocks << block;
+	return true;
+}
+
+bool SeriesStore::reserve(qint64 offset, qint64 bytes)
+{
+	/* Разреженный файл при нехватке места на диске дал бы SIGBUS при
+	 * записи в отображение, поэтому место выделяется заранее */
+#ifdef Q_OS_LINUX
+	return posix_fallocate(m_file->handle(), offset, bytes) == 0;
+#else
+	static const QByteArray zeros(1 << 20, '\0');
+
+	if( !m_file->seek(offset) )
+		return false;
+
+	for(qint64 left = bytes; left > 0; left -= zeros.size())
+		if( m_file->write(zeros.constData(), qMin<qint64>(left, zeros.size())) < 0 )
+			return false;
+
+	return m_file->flush();
+#endif
+}
+
+void SeriesStore::growBlock(Block &block, qint64 points)
+{
+	// Емкость удваивается, чтобы короткий ряд не занимал целый блок
+	const qint64 size = qMin(blockPoints, qMax(points, 2 * static_cast<qint64>( block.ram.size() )));
+
+	block.ram.reserve(static_cast<int>( size ));
+	block.ram.resize(static_cast<int>( size ));
+	block.data = block.ram.data();
+}
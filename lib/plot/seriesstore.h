@@ -0,0 +1,88 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include <QVector>
+#include <QPointF>
+#include <QTemporaryFile>
+#include <QScopedPointer>
+
+/* Хранилище ряда блоками по blockPoints точек с 64-битной индексацией.
+ * Пока объем укладывается в бюджет памяти, блоки лежат в ОЗУ, сверх
+ * бюджета - в отображенном в память временном файле. Для каждого блока
+ * в ОЗУ хранится сводка min/max по y, достаточная для нормировки */
+class PLOTENGINE_EXPORT SeriesStore
+{
+public:
+	static const int blockShift = 20;
+	static const qint64 blockPoints = Q_INT64_C(1) << blockShift;
+
+	struct Summary
+	{
+		double yMin = 0, yMax = 0;
+		double yMaxAbs = 0;
+	};
+
+	SeriesStore();
+	~SeriesStore();
+
+	// Бюджет ОЗУ в байтах, 0 - без ограничений
+	void setBudget(qint64 bytes);
+	qint64 budget() const;
+
+	qint64 size() const { return m_size; }
+	bool isEmpty() const { return m_size == 0; }
+	// Сколько байт ряда вынесено на диск
+	qint64 bytesOnDisk() const;
+
+	inline const QPointF &at(qint64 i) const;
+	const QPointF &first() const { return at(0); }
+	const QPointF &last() const { return at(m_size - 1); }
+
+	bool append(const QPointF *points, qint64 count);
+	bool append(const QVector<QPointF> &);
+	void clear();
+	// Обмен рядами без копирования точек, бюджеты остаются прежними
+	void swap(SeriesStore &);
+
+	// Копия в непрерывном массиве, пустая если не помещается в QVector
+	QVector<QPointF> toVector() const;
+
+	int blockCount() const { return m_blocks.size(); }
+	const Summary &summary(int block) const { return m_blocks[block].summary; }
+	// Точки блока подряд, для поблочного обхода без копирования
+	const QPointF *blockData(int block) const { return m_blocks[block].data; }
+	qint64 blockSize(int block) const { return m_blocks[block].count; }
+
+	// Оценка объема ряда из points точек
+	static qint64 estimate(qint64 points);
+	// Свободное место для вынесенных на диск блоков
+	static qint64 availableDisk();
+
+private:
+	struct Block
+	{
+		QPointF *data = nullptr;
+		QVector<QPointF> ram;	// Пуст для блоков на диске, растет до blockPoints
+		uchar *mapped = nullptr;
+		qint64 count = 0;
+		Summary summary;
+	};
+
+	bool addBlock();
+	bool reserve(qint64 offset, qint64 bytes);
+	void growBlock(Block &, qint64 points);
+
+private:
+	Q_DISABLE_COPY(SeriesStore)
+
+	qint64 m_budget = 0;
+	qint64 m_size = 0;
+	QVector<Block> m_blocks;
+	int m_diskBlocks = 0;
+	QScopedPointer<QTemporaryFile> m_file;	// Создается при первом вытеснении
+};
+
+const QPointF &SeriesStore::at(qint64 i) const
+{
+	return m_blocks[static_cast<int>( i >> blockShift )].data[i & (blockPoints - 1)];
+}
@@ -0,0 +1,268 @@
+#include "sharedseries.h"
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "SharedSeries stores points as QPointF");
+
+namespace
+{
+
+void setError(QString *error, const QString &text)
+{
+	if( error )
+		*error = text;
+}
+
+QString systemError(const QString &what)
+{
+	return QString("%1: %2").arg(what, QString::fromLocal8Bit(std::strerror(errno)));
+}
+
+}
+
+qint64 SharedSeries::sizeFor(quint64 capacity)
+{
+	// Объем должен помещаться и в off_t, и в size_t для mmap
+	const quint64 limit = qMin<quint64>(std::numeric_limits<qint64>::max(), std::numeric_limits<size_t>::max());
+
+	if( capacity > (limit - sizeof(Header)) / sizeof(QPointF) )
+		return -1;
+
+	return static_cast<qint64>( sizeof(Header) + capacity * sizeof(QPointF) );
+}
+
+/* SharedSeriesWriter */
+
+SharedSeriesWriter::~SharedSeriesWriter()
+{
+	close();
+}
+
+bool SharedSeriesWriter::create(const QString &name, quint64 capacity, QString *error)
+{
+	close();
+
+	if( capacity == 0 ) {
+		setError(error, "Capacity must be positive");
+		return false;
+	}
+
+	if( SharedSeries::sizeFor(capacity) < 0 ) {
+		setError(error, "Capacity is too large");
+		return false;
+	}
+
+#ifdef Q_OS_UNIX
+	const QByteArray path = name.toLocal8Bit();
+	const qint64 size = SharedSeries::sizeFor(capacity);
+
+	// Подключенные читатели сохраняют старый объект до отключения
+	shm_unlink(path.constData());
+
+	const int fd = shm_open(path.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if( fd < 0 ) {
+		setError(error, systemError("shm_open"));
+		return false;
+	}
+
+	if( ftruncate(fd, size) != 0 ) {
+		setError(error, systemError("ftruncate"));
+		::close(fd);
+		shm_unlink(path.constData());
+		return false;
+	}
+
+	void *memory = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if( memory == MAP_FAILED ) {
+		setError(error, systemError("mmap"));
+		shm_unlink(path.constData());
+		return false;
+	}
+
+	m_name = name;
+	m_size = size;
+	m_header = static_cast<SharedSeries::Header *>(memory);
+	m_points = reinterpret_cast<QPointF *>( static_cast<char *>(memory) + sizeof(SharedSeries::Header) );
+
+	// Объект после ftruncate заполнен нулями, magic пишется последним
+	m_header->version = SharedSeries::version;
+	m_header->capacity = capacity;
+	m_header->written.store(0, std::memory_order_relaxed);
+	m_header->writing.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->magic = SharedSeries::magic;
+
+	return true;
+#else
+	Q_UNUSED(name)
+	setError(error, "Shared memory series are supported on POSIX systems only");
+	return false;
+#endif
+}
+
+void SharedSeriesWriter::close(bool unlink)
+{
+#ifdef Q_OS_UNIX
+	if( m_header ) {
+		munmap(m_header, static_cast<size_t>(m_size));
+
+		if( unlink )
+			shm_unlink(m_name.toLocal8Bit().constData());
+	}
+#else
+	Q_UNUSED(unlink)
+#endif
+
+	m_header = nullptr;
+	m_points = nullptr;
+	m_size = 0;
+	m_capacity = 0;
+	m_name.clear();
+}
+
+void SharedSeriesWriter::append(const QPointF *points, quint64 count)
+{
+	if( !m_header || count == 0 )
+		return;
+
+	const quint64 capacity = m_header->capacity;
+	const quint64 written = m_header->written.load(std::memory_order_relaxed);
+	// Из пакета больше емкости в кольце останутся только последние точки
+	const quint64 skip = count > capacity ? count - capacity : 0;
+
+	m_header->writing.store(written + count, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for(quint64 i = skip; i < count; ++i)
+		m_points[(written + i) % capacity] = points[i];
+
+	m_header->written.store(written + count, std::memory_order_release);
+}
+
+void SharedSeriesWriter::append(double x, double y)
+{
+	const QPointF point(x, y);
+	append(&point, 1);
+}
+
+/* SharedSeriesReader */
+
+SharedSeriesReader::~SharedSeriesReader()
+{
+	detach();
+}
+
+bool SharedSeriesReader::attach(const QString &name, QString *error)
+{
+	detach();
+
+#ifdef Q_OS_UNIX
+	const int fd = shm_open(name.toLocal8Bit().constData(), O_RDONLY, 0);
+	if( fd < 0 ) {
+		setError(error, systemError("shm_open"));
+		return false;
+	}
+
+	struct stat st;
+	if( fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>( sizeof(SharedSeries::Header) ) ) {
+		setError(error, "Not a shared series object");
+		::close(fd);
+		return false;
+	}
+
+	void *memory = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if( memory == MAP_FAILED ) {
+		setError(error, systemError("mmap"));
+		return false;
+	}
+
+	const auto header = static_cast<const SharedSeries::Header *>(memory);
+	const quint32 magic = header->magic;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	// Емкость читается один раз: проверяется и используется одно и то же значение
+	const quint64 capacity = header->capacity;
+
+	QString problem;
+	if( magic != SharedSeries::magic )
+		problem = "Not a shared series object";
+	else if( header->version != SharedSeries::version )
+		problem = QString("Unsupported shared series version %1").arg(header->version);
+	else if( capacity == 0 || SharedSeries::sizeFor(capacity) < 0
+			|| SharedSeries::sizeFor(capacity) > st.st_size )
+		problem = "Shared series object is truncated";
+
+	if( !problem.isEmpty() ) {
+		setError(error, problem);
+		munmap(memory, static_cast<size_t>(st.st_size));
+		return false;
+	}
+
+	m_name = name;
+	m_size = st.st_size;
+	m_header = header;
+	m_points = reinterpret_cast<const QPointF *>( static_cast<const char *>(memory) + sizeof(SharedSeries::Header) );
+	m_capacity = capacity;
+
+	return true;
+#else
+	Q_UNUSED(name)
+	setError(error, "Shared memory series are supported on POSIX systems only");
+	return false;
+#endif
+}
+
+void SharedSeriesReader::detach()
+{
+#ifdef Q_OS_UNIX
+	if( m_header )
+		munmap(const_cast<SharedSeries::Header *>(m_header), static_cast<size_t>(m_size));
+#endif
+
+	m_header = nullptr;
+	m_points = nullptr;
+	m_size = 0;
+	m_name.clear();
+}
+
+bool SharedSeriesReader::isAttached() const
+{
+	return m_header != nullptr;
+}
+
+QString SharedSeriesReader::name() const
+{
+	return m_name;
+}
+
+quint64 SharedSeriesReader::capacity() const
+{
+	return m_capacity;
+}
+
+quint64 SharedSeriesReader::written() const
+{
+	return m_header ? m_header->written.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedSeriesReader::isIntact(quint64 first) const
+{
+	if( !m_header )
+		return false;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const quint64 writing = m_header->writing.load(std::memory_order_relaxed);
+
+	return writing <= m_capacity || writing - m_capacity <= first;
+}
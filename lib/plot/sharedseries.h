@@ -0,0 +1,102 @@
+#pragma once
+
+#include "plotengine_global.h"
+#include <QString>
+#include <QPointF>
+#include <atomic>
+
+/* Кольцевой буфер точек в разделяемой памяти POSIX (shm_open) для
+ * передачи ряда из другого процесса без промежуточных файлов.
+ *
+ * Раскладка объекта, все поля в порядке байтов платформы:
+ *   0   u32  magic     SharedSeries::magic ("SPVS")
+ *   4   u32  version   SharedSeries::version
+ *   8   u64  capacity  число точек в кольце
+ *   16  u64  written   всего опубликовано точек, монотонно растет
+ *   24  u64  writing   written плюс записываемые сейчас точки
+ *   32  u64  reserved[4]
+ *   64  capacity точек {double x; double y}, точка i лежит в ячейке i % capacity
+ *
+ * Счетчики работают как seqlock. Писатель объявляет writing, ставит
+ * барьер release, записывает точки и публикует written (release).
+ * Читатель берет written (acquire), читает окно [written - capacity,
+ * written), ставит барьер acquire и берет writing: точки с номером меньше
+ * writing - capacity за время чтения могли быть перезаписаны.
+ * Значения x внутри кольца должны возрастать */
+namespace SharedSeries
+{
+	const quint32 magic = 0x53505653;
+	const quint32 version = 1;
+
+	struct Header
+	{
+		quint32 magic;
+		quint32 version;
+		quint64 capacity;
+		std::atomic<quint64> written;
+		std::atomic<quint64> writing;
+		quint64 reserved[4];
+	};
+
+	static_assert(sizeof(Header) == 64, "SharedSeries::Header layout");
+
+	// Размер объекта на capacity точек, -1 если он не представим
+	PLOTENGINE_EXPORT qint64 sizeFor(quint64 capacity);
+}
+
+/* Сторона производителя: создает объект и дописывает точки */
+class PLOTENGINE_EXPORT SharedSeriesWriter
+{
+public:
+	SharedSeriesWriter() = default;
+	~SharedSeriesWriter();
+
+	// Создает или пересоздает объект name ("/имя") на capacity точек
+	bool create(const QString &name, quint64 capacity, QString *error = nullptr);
+	void close(bool unlink = true);
+
+	void append(const QPointF *points, quint64 count);
+	void append(double x, double y);
+
+private:
+	Q_DISABLE_COPY(SharedSeriesWriter)
+
+	QString m_name;
+	SharedSeries::Header *m_header = nullptr;
+	QPointF *m_points = nullptr;
+	qint64 m_size = 0;
+};
+
+/* Сторона просмотра: отображает объект только для чтения, точки
+ * читаются прямо из разделяемой памяти */
+class PLOTENGINE_EXPORT SharedSeriesReader
+{
+public:
+	SharedSeriesReader() = default;
+	~SharedSeriesReader();
+
+	bool attach(const QString &name, QString *error = nullptr);
+	void detach();
+	bool isAttached() const;
+	QString name() const;
+
+	quint64 capacity() const;
+	quint64 written() const;
+	// Точка с общим номером index, index < written()
+	QPointF at(quint64 index) const
+	{
+		return m_points[index % m_capacity];
+	}
+	// Точки начиная с first не перезаписаны с момента чтения written()
+	bool isIntact(quint64 first) const;
+
+private:
+	Q_DISABLE_COPY(SharedSeriesReader)
+
+	QString m_name;
+	const SharedSeries::Header *m_header = nullptr;
+	const QPointF *m_points = nullptr;
+	qint64 m_size = 0;
+	// Проверенная при attach() емкость, заголовок в памяти может испортить писатель
+	quint64 m_capacity = 0;
+};
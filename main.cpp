@@ -1,8 +1,63 @@
 #include "mainwindow.h"
+#include "lib/plot/plotreplay.h"
 #include <QApplication>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <cstdio>
+
+/* simple-plot --replay <corpus> <golden-dir> [--update]
+ * прогоняет корпус без окна и сверяет результат с эталонами,
+ * для корпуса репозитория: --replay replay/corpus.txt replay/golden */
+static int replay(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication a(argc, argv);
+    QStringList args = a.arguments();
+    QTextStream out(stdout);
+
+    const bool update = args.removeAll("--update") > 0;
+    const int i = args.indexOf("--replay");
+
+    if( i + 2 >= args.size() ) {
+        out << "Usage: " << args.first() << " --replay <corpus> <golden-dir> [--update]\n";
+        return 2;
+    }
+
+    return PlotReplay::replay(args[i + 1], args[i + 2], update, out) == 0 ? 0 : 1;
+}
+
+/* simple-plot --benchmark [points]
+ * сравнивает общий и специализированный циклы встроенных функций
+ * и цену режимов точности PlotPrecision */
+static int benchmark(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    const QStringList args = a.arguments();
+    const int i = args.indexOf("--benchmark");
+    QTextStream out(stdout);
+    bool ok = true;
+    const int points = i + 1 < args.size() ? args[i + 1].toInt(&ok) : 10000000;
+
+    if( !ok || points < 1 ) {
+        out << "Usage: " << args.first() << " --benchmark [points]\n";
+        return 2;
+    }
+
+    PlotReplay::benchmark(points, out);
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    for(int i = 1; i < argc; ++i) {
+        if( qstrcmp(argv[i], "--replay") == 0 )
+            return replay(argc, argv);
+        if( qstrcmp(argv[i], "--benchmark") == 0 )
+            return benchmark(argc, argv);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -1,6 +1,11 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "tablewindow.h"
+#include "sweepwindow.h"
+#include "lib/plot/functions.h"
+#include "lib/plot/derivedseries.h"
+#include "lib/plot/plotengine.h"
+#include "lib/plot/seriesstore.h"
 #include <QDebug>
 #include <QPaintEvent>
 #include <QMouseEvent>
@@ -8,6 +13,11 @@
 #include <QFile>
 #include <QDataStream>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QLineEdit>
+#include <QtConcurrent>
+#include <QThreadPool>
 #include <functional>
 #include <cmath>
 
@@ -19,6 +29,7 @@ MainWindow::MainWindow(QWidget *parent)
 	setupTimer();
 	setupPlot();
 	setupConnections();
+	updateEstimate();
 
 	m_plot.installEventFilter(this);
 	setWindowTitle("simple-plot-viewer");
@@ -26,6 +37,11 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+	dropSpeculative();
+
+	// Экспорт сообщает о ходе в это окно, оно должно его пережить
+	m_exportWatcher.waitForFinished();
+
 	delete ui;
 }
 
@@ -44,14 +60,47 @@ bool MainWindow::eventFilter(QObject *object, QEvent *event)
 
 void MainWindow::start(bool saveOldData)
 {
-	if( !m_plot.isRunning() ) {
-		if( !saveOldData )
-			m_plot.clear();
+	const qint64 budget = qint64(ui->sbBudget->value()) << 20;
+	const qint64 estimate = PlotEngine::estimateMemory(ui->sbFrom->value(), ui->sbTo->value(), ui->sbStep->value());
 
-		enableGUI(false);
-		calculate();
-		m_refreshTimer.start();
+	if( PlotEngine::gridSize(ui->sbFrom->value(), ui->sbTo->value(), ui->sbStep->value()) == 0 ) {
+		QMessageBox::warning(this, "Interval", invalidGridMessage(), QMessageBox::Ok);
+		return;
 	}
+
+	if( budget > 0 && estimate > budget ) {
+		const auto answer = QMessageBox::question(this, "Memory budget",
+			QString("The series needs %1 MB, %2 MB of it will be stored in a temporary file. Continue?")
+				.arg(estimate >> 20).arg((estimate - budget) >> 20));
+
+		if( answer != QMessageBox::Yes )
+			return;
+
+		const qint64 available = SeriesStore::availableDisk();
+
+		if( estimate - budget > available ) {
+			QMessageBox::warning(this, "Memory budget",
+				QString("The temporary file needs %1 MB, only %2 MB are free on the disk.")
+					.arg((estimate - budget) >> 20).arg(available >> 20));
+			return;
+		}
+	}
+
+	// Идущий расчет не ждет завершения: новая задача заменяет его,
+	// а прежняя отменяется и досчитывает в фоне в свои буферы
+	if( ui->btnPause->isChecked() )
+		ui->btnPause->click();
+
+	// Обычный запуск заменяет отложенный живой пересчет, кэш упреждения ему не нужен
+	m_liveTimer.stop();
+	dropSpeculative();
+
+	if( !saveOldData )
+		m_plot.clear();
+
+	enableGUI(false);
+	calculate();
+	m_refreshTimer.start();
 }
 
 void MainWindow::pause(bool btnState)
@@ -78,6 +127,14 @@ void MainWindow::interrupt()
 
 void MainWindow::calculate()
 {
+	setupCalculation();
+	m_plot.start();
+}
+
+void MainWindow::setupCalculation()
+{
+	m_attached = false;
+
 	const auto A = ui->sbA->value();
 	const auto B = ui->sbB->value();
 	const auto C = ui->sbC->value();
@@ -86,43 +143,32 @@ void MainWindow::calculate()
 	const auto step = ui->sbStep->value();
 	const auto fName = ui->cbFunctions->currentText().mid(QString("f(x) = ").length());
 	const auto fIndex =  ui->cbFunctions->currentIndex();
-	std::function<double(double)> f;
-
-	if( fIndex == 0 ) {
-		f = [A, B, C](double x){ return A*(x*x) + B*x + C; };
-		m_plot.setFunction(f, fName);
-	}
-
-	else if( fIndex == 1 ) {
-		auto f = [A, B, C](double x){ return A*sin(x) + B*cos(C*x); };
-		m_plot.setFunction(f, fName);
-	}
-
-	else if( fIndex == 2 ) {
-		auto f = [A, B](double x){ return A*log(B*x); };
-		m_plot.setFunction(f, fName);
-	}
-
-	else if( fIndex == 3 ) {
-		auto f = [A, B](double x){ return A / ( B*sin(x*x) ); };
-		m_plot.setFunction(f, fName);
-	}
-
-	else
-		Q_UNREACHABLE();
 
+	m_plot.setFunction(PlotFunctions::make(fIndex, A, B, C), fName);
+	m_plot.setExtendedFunction(PlotFunctions::makeExtended(fIndex, A, B, C));
+	m_plot.setFunctionBatch(PlotFunctions::makeBatch(fIndex, A, B, C));
+	m_plot.setPrecision(static_cast<PlotPrecision>(ui->cbPrecision->currentIndex()));
 	m_plot.setParams(A, B, C);
 	m_plot.setInterval(from, to, step);
-	m_plot.start();
+	m_plot.setMemoryBudget(qint64(ui->sbBudget->value()) << 20);
+	m_plot.setProgressive(ui->cbProgressive->isChecked());
+
+	m_calculated = liveParams();
 }
 
 void MainWindow::calculateReady()
 {
 	//	qDebug() << "calculateReady";
+	m_attached = false;
 	ui->btnStart->setText(QString("%1").arg("New"));
+	ui->lblElapsed->setText(QString("%1: %2 ms").arg(ui->cbPrecision->currentText()).arg(m_plot.elapsed()));
 	enableGUI(true);
 	m_refreshTimer.stop();
 	m_plot.update();
+	updateOverlay();
+
+	if( ui->cbLive->isChecked() )
+		speculate();
 }
 
 void MainWindow::setProgress(int progress)
@@ -133,6 +179,11 @@ void MainWindow::setProgress(int progress)
 
 void MainWindow::store()
 {
+	if( !m_plot.isSeriesResident() ) {
+		QMessageBox::warning(this, "Save error", tooLargeMessage(), QMessageBox::Ok);
+		return;
+	}
+
 	const QString fileName = QFileDialog::getSaveFileName(m_tableWindow, "Save series");
 
 	if( fileName.isEmpty() )
@@ -146,18 +197,14 @@ void MainWindow::store()
 	}
 
 	QDataStream stream(&ofile);
-	double A, B, C;
-	double from, to, step;
-	auto fName = m_plot.functionName();
+	PlotEngine::Record record;
 
-	m_plot.getParams(A, B, C);
-	m_plot.getInterval(from, to, step);
+	record.function = m_plot.functionName();
+	m_plot.getParams(record.A, record.B, record.C);
+	m_plot.getInterval(record.from, record.to, record.step);
+	record.series = m_plot.series();
 
-	stream << fName
-		   << A << B << C
-		   << from << to << step;
-
-	stream << m_plot.series();
+	PlotEngine::write(stream, record);
 
 	ofile.close();
 }
@@ -177,26 +224,32 @@ void MainWindow::load()
 	}
 
 	QDataStream stream(&ifile);
-	double A, B, C;
-	double from, to, step;
-	QString fName;
+	PlotEngine::Record record;
 
-	stream >> fName;
-	stream >> A >> B >> C
-			>> from >> to >> step;
+	if( !PlotEngine::read(stream, record) ) {
+		QMessageBox::warning(this, "Open error", "Corrupted series file", QMessageBox::Ok);
+		return;
+	}
 
-	m_plot.setParams(A, B, C);
-	m_plot.setInterval(from, to, step);
+	m_plot.setParams(record.A, record.B, record.C);
+	m_plot.setInterval(record.from, record.to, record.step);
 
-	ui->cbFunctions->setCurrentIndex(ui->cbFunctions->findText("f(x) = " + fName));
-	ui->sbA->setValue(A); ui->sbB->setValue(B); ui->sbC->setValue(C);
-	ui->sbFrom->setValue(from); ui->sbTo->setValue(to); ui->sbStep->setValue(step);
+	// Иначе правки запускают живой пересчет, и он заменяет загруженный ряд
+	const QList<QWidget *> editors = {ui->cbFunctions, ui->sbA, ui->sbB, ui->sbC, ui->sbFrom, ui->sbTo, ui->sbStep};
+	for(QWidget *editor: editors)
+		editor->blockSignals(true);
 
-	QVector<QPointF> series;
-	stream >> series;
+	ui->cbFunctions->setCurrentIndex(ui->cbFunctions->findText("f(x) = " + record.function));
+	ui->sbA->setValue(record.A); ui->sbB->setValue(record.B); ui->sbC->setValue(record.C);
+	ui->sbFrom->setValue(record.from); ui->sbTo->setValue(record.to); ui->sbStep->setValue(record.step);
+
+	for(QWidget *editor: editors)
+		editor->blockSignals(false);
+
+	updateEstimate();
 
 	m_plot.clear();
-	m_plot.setSeries(series);
+	m_plot.setSeries(record.series);
 	start(true);
 
 	ifile.close();
@@ -204,6 +257,129 @@ void MainWindow::load()
 	m_tableWindow->close();
 }
 
+void MainWindow::sweep()
+{
+	if( m_sweepWindow.isNull() )
+		m_sweepWindow = new SweepWindow(this);
+
+	if( m_sweepWindow->isHidden() ) {
+		const auto fName = ui->cbFunctions->currentText().mid(QString("f(x) = ").length());
+
+		m_sweepWindow->setFunction(ui->cbFunctions->currentIndex(), fName);
+		m_sweepWindow->setParams(ui->sbA->value(), ui->sbB->value(), ui->sbC->value());
+		m_sweepWindow->setInterval(ui->sbFrom->value(), ui->sbTo->value(), ui->sbStep->value());
+	}
+
+	m_sweepWindow->show();
+}
+
+void MainWindow::attach()
+{
+	bool ok = false;
+	const QString name = QInputDialog::getText(this, "Attach", "Shared memory object",
+											   QLineEdit::Normal, "/simple-plot", &ok);
+
+	if( !ok || name.isEmpty() )
+		return;
+
+	if( ui->btnPause->isChecked() )
+		ui->btnPause->click();
+
+	QString error;
+	if( !m_plot.attach(name, &error) ) {
+		QMessageBox::warning(this, "Attach", error);
+		return;
+	}
+
+	// Просмотр продолжается до Break
+	m_attached = true;
+	enableGUI(false);
+	ui->btnStart->setText(QString("Attached: %1").arg(name));
+	m_refreshTimer.start();
+}
+
+void MainWindow::exportImage()
+{
+	const QString fileName = QFileDialog::getSaveFileName(this, "Export plot", QString(),
+														  "PNG (*.png);;SVG (*.svg);;PDF (*.pdf)");
+
+	if( fileName.isEmpty() )
+		return;
+
+	bool ok = false;
+	const int side = QInputDialog::getInt(this, "Export plot", "Size, px", 2048, 16, 32000, 1, &ok);
+
+	if( !ok || m_exportWatcher.isRunning() )
+		return;
+
+	m_exportProgress = new QProgressDialog("Exporting " + fileName, QString(), 0, 100, this);
+	m_exportProgress->setAttribute(Qt::WA_DeleteOnClose);
+	m_exportProgress->setWindowModality(Qt::WindowModal);
+	m_exportProgress->setMinimumDuration(500);
+	ui->btnExport->setEnabled(false);
+
+	// Ход экспорта приходит из рабочего потока и передается окну очередью
+	m_exportWatcher.setFuture(m_plot.exportTo(fileName, QSize(side, side), [this](int percent)
+	{
+		QMetaObject::invokeMethod(this, [this, percent]()
+		{
+			if( m_exportProgress )
+				m_exportProgress->setValue(percent);
+		}, Qt::QueuedConnection);
+	}));
+}
+
+void MainWindow::exportReady()
+{
+	const QString error = m_exportWatcher.result();
+
+	if( m_exportProgress )
+		m_exportProgress->close();
+
+	ui->btnExport->setEnabled(true);
+
+	if( !error.isEmpty() )
+		QMessageBox::warning(this, "Export error", error, QMessageBox::Ok);
+}
+
+void MainWindow::updateOverlay()
+{
+	const auto operation = static_cast<DerivedSeries::Operation>(ui->cbDerived->currentIndex());
+
+	if( operation == DerivedSeries::None || m_plot.isRunning() ) {
+		m_plot.setOverlay(QImage());
+		return;
+	}
+
+	/* Производный ряд считается по блокам хранилища задачи, в том числе
+	 * вытесненным на диск, прореживается и рисуется в исполнителе - окну
+	 * достается готовое изображение. setFuture() отвязывает наблюдателя
+	 * от еще не готового прежнего результата */
+	const PlotJobHandle job = m_plot.currentJob();
+	m_overlayWatcher.setFuture(QtConcurrent::run(PlotJob::executor(), [operation, job]()
+	{
+		return Plot::overlayImage(job->derive(operation, Plot::overlaySide));
+	}));
+}
+
+void MainWindow::updateEstimate()
+{
+	const qint64 budget = qint64(ui->sbBudget->value()) << 20;
+	const qint64 estimate = PlotEngine::estimateMemory(ui->sbFrom->value(), ui->sbTo->value(), ui->sbStep->value());
+
+	if( estimate == 0 ) {
+		ui->lblEstimate->setText("Series: invalid interval");
+		return;
+	}
+
+	QString text = QString("Series: %1 MB").arg(estimate / double(1 << 20), 0, 'f', 1);
+
+	if( budget > 0 && estimate > budget )
+		text += QString(", %1 MB on disk").arg((estimate - budget) / double(1 << 20), 0, 'f', 1);
+
+	ui->lblEstimate->setText(text);
+}
+
 /* Private */
 
 void MainWindow::setupUi()
@@ -213,6 +389,157 @@ void MainWindow::setupUi()
 	populateFunctionComboBox();
 }
 
+void MainWindow::scheduleLive()
+{
+	// Каждая правка откладывает пересчет, считается только последнее значение
+	if( ui->cbLive->isChecked() )
+		m_liveTimer.start();
+}
+
+void MainWindow::recomputeLive()
+{
+	if( !ui->cbLive->isChecked() )
+		return;
+
+	if( ui->btnPause->isChecked() )
+		ui->btnPause->click();
+
+	const LiveParams params = liveParams();
+	const auto cached = m_speculative.value(liveKey(params));
+	const qint64 budget = qint64(ui->sbBudget->value()) << 20;
+	const qint64 points = PlotEngine::gridSize(params.from, params.to, params.step);
+	const qint64 spill = budget > 0 ? SeriesStore::estimate(points) - budget : 0;
+
+	// Устаревший расчет отменяется заменой текущей задачи
+	m_plot.clear();
+
+	// Без вопросов, как в start(), живой режим не выходит за место на диске
+	if( points == 0 || spill > SeriesStore::availableDisk() ) {
+		ui->lblElapsed->setText(points == 0 ? QString("Live: %1").arg(invalidGridMessage())
+											: QString("Live: %1 MB exceed the free disk space").arg(spill >> 20));
+		enableGUI(true);
+		m_refreshTimer.stop();
+		return;
+	}
+
+	setupCalculation();
+
+	// Ряд переносится из кэша без копирования, остается только отрисовка.
+	// Грубому предпросмотру с уточнением нужен плотный массив в ОЗУ, сверх
+	// бюджета расчет идет обычным порядком с вытеснением на диск
+	if( cached && cached->state() == PlotJob::Finished && !cached->isEmpty() )
+		m_plot.takeSeries(cached);
+	else if( PlotJob::fitsProgressive(points, budget) )
+		m_plot.setProgressive(true);
+
+	enableGUI(false);
+	m_plot.start();
+	m_refreshTimer.start();
+}
+
+void MainWindow::speculate()
+{
+	// Соседи считаются вокруг параметров досчитанной задачи,
+	// интерфейс за время расчета мог уйти вперед
+	const LiveParams base = m_calculated;
+	QHash<QString, PlotJobHandle> speculative;
+
+	// Упреждение и кэш - только для небольших рядов в ОЗУ
+	if( PlotEngine::estimateMemory(base.from, base.to, base.step) <= speculationLimit ) {
+		// Только что досчитанный ряд тоже попадает в кэш, возврат к нему мгновенный
+		const auto current = m_plot.currentJob();
+		if( current->state() == PlotJob::Finished && current->bytesOnDisk() == 0 )
+			speculative.insert(liveKey(base), current);
+
+		// Одно ядро остается под основной расчет
+		QThreadPool *executor = PlotJob::executor();
+		int idle = executor->maxThreadCount() - executor->activeThreadCount() - 1;
+
+		const QSpinBox *boxes[] = {ui->sbA, ui->sbB, ui->sbC};
+		for(int k = 0; k < 3; ++k) {
+			for(int sign: {-1, 1}) {
+				LiveParams neighbour = base;
+				int *params[] = {&neighbour.A, &neighbour.B, &neighbour.C};
+				*params[k] += sign * boxes[k]->singleStep();
+
+				if( *params[k] < boxes[k]->minimum() || *params[k] > boxes[k]->maximum() )
+					continue;
+
+				const QString key = liveKey(neighbour);
+				PlotJobHandle job = m_speculative.value(key);
+
+				if( !job ) {
+					if( idle <= 0 )
+						continue;
+
+					const int fIndex = neighbour.fIndex;
+					const int A = neighbour.A, B = neighbour.B, C = neighbour.C;
+
+					PlotJobConfig config;
+					config.f = PlotFunctions::make(fIndex, A, B, C);
+					config.fExtended = PlotFunctions::makeExtended(fIndex, A, B, C);
+					config.batch = PlotFunctions::makeBatch(fIndex, A, B, C);
+					config.precision = static_cast<PlotPrecision>(neighbour.precision);
+					config.from = neighbour.from;
+					config.to = neighbour.to;
+					config.step = neighbour.step;
+					config.budget = qint64(ui->sbBudget->value()) << 20;
+					config.priority = -1; // Основной расчет обходит очередь упреждающих
+
+					job = PlotJob::create(config);
+					job->start();
+					--idle;
+				}
+
+				speculative.insert(key, job);
+			}
+		}
+	}
+
+	// Значения, ставшие несоседними, больше не нужны
+	for(auto it = m_speculative.cbegin(); it != m_speculative.cend(); ++it)
+		if( !speculative.contains(it.key()) )
+			it.value()->cancel();
+
+	m_speculative = speculative;
+}
+
+void MainWindow::dropSpeculative()
+{
+	for(const auto &job: m_speculative)
+		job->cancel();
+
+	m_speculative.clear();
+}
+
+MainWindow::LiveParams MainWindow::liveParams() const
+{
+	LiveParams params;
+	params.fIndex = ui->cbFunctions->currentIndex();
+	params.A = ui->sbA->value();
+	params.B = ui->sbB->value();
+	params.C = ui->sbC->value();
+	params.from = ui->sbFrom->value();
+	params.to = ui->sbTo->value();
+	params.step = ui->sbStep->value();
+	params.precision = ui->cbPrecision->currentIndex();
+
+	return params;
+}
+
+QString MainWindow::liveKey(const LiveParams &params)
+{
+	// Все параметры, от которых зависит ряд
+	return QStringList{
+		QString::number(params.fIndex),
+		QString::number(params.A), QString::number(params.B), QString::number(params.C),
+		QString::number(params.from, 'g', 17),
+		QString::number(params.to, 'g', 17),
+		QString::number(params.step, 'g', 17),
+		QString::number(params.precision)
+	}.join('|');
+}
+
 void MainWindow::setupPlot()
 {
 
@@ -228,15 +555,21 @@ void MainWindow::setupTimer()
 		if( !m_plot.isRunning() || m_plot.isPaused() )
 			return;
 
-		setProgress(m_plot.progress());
-		m_plot.update();
+		if( !m_attached )
+			setProgress(m_plot.progress());
+		m_plot.refresh();
 	});
+
+	m_liveTimer.setParent(this);
+	m_liveTimer.setSingleShot(true);
+	m_liveTimer.setInterval(liveDelay);
+
+	connect(&m_liveTimer, &QTimer::timeout, this, &MainWindow::recomputeLive);
 }
 
 void MainWindow::populateFunctionComboBox()
 {
-	const auto fNames = {"A*(x*x) + B*x + C", "A*sin(x) + B*cos(C*x)",
-						 "A*log(B*x)", "A / ( B*sin(x*x) )"};
+	const auto fNames = PlotFunctions::names();
 
 	for(const auto &fName: fNames)
 		ui->cbFunctions->addItem(QString("f(x) = ") + fName);
@@ -247,18 +580,54 @@ void MainWindow::setupConnections()
 	connect(ui->btnStart, &QPushButton::clicked, this, &MainWindow::start);
 	connect(ui->btnPause, &QPushButton::toggled, this, &MainWindow::pause);
 	connect(ui->btnBreak, &QPushButton::clicked, this, &MainWindow::interrupt);
+	connect(ui->btnSweep, &QPushButton::clicked, this, &MainWindow::sweep);
+	connect(ui->btnAttach, &QPushButton::clicked, this, &MainWindow::attach);
+	connect(ui->btnExport, &QPushButton::clicked, this, &MainWindow::exportImage);
+	connect(ui->cbDerived, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::updateOverlay);
+	connect(ui->sbFrom, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::updateEstimate);
+	connect(ui->sbTo, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::updateEstimate);
+	connect(ui->sbStep, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::updateEstimate);
+	connect(ui->sbBudget, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::updateEstimate);
+	connect(&m_exportWatcher, &QFutureWatcher<QString>::finished, this, &MainWindow::exportReady);
+	connect(&m_overlayWatcher, &QFutureWatcher<QImage>::finished, this, [this]()
+	{
+		m_plot.setOverlay(m_overlayWatcher.result());
+	});
 	connect(&m_plot, &Plot::resultReady, this, &MainWindow::calculateReady);
+
+	for(QSpinBox *box: {ui->sbA, ui->sbB, ui->sbC, ui->sbTo})
+		connect(box, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::scheduleLive);
+	for(QDoubleSpinBox *box: {ui->sbFrom, ui->sbStep})
+		connect(box, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::scheduleLive);
+	connect(ui->cbFunctions, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::scheduleLive);
+	connect(ui->cbPrecision, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::scheduleLive);
+	connect(ui->cbLive, &QCheckBox::toggled, this, [this](bool live)
+	{
+		if( live )
+			scheduleLive();
+		else {
+			m_liveTimer.stop();
+			dropSpeculative();
+			enableGUI(!m_plot.isRunning());
+		}
+	});
 }
 
 void MainWindow::enableGUI(bool isEnable)
 {
-	ui->cbFunctions->setEnabled(isEnable);
-	ui->sbA->setEnabled(isEnable);
-	ui->sbB->setEnabled(isEnable);
-	ui->sbC->setEnabled(isEnable);
-	ui->sbFrom->setEnabled(isEnable);
-	ui->sbTo->setEnabled(isEnable);
-	ui->sbStep->setEnabled(isEnable);
+	// В живом режиме параметры правятся и во время расчета
+	const bool editable = isEnable || ui->cbLive->isChecked();
+
+	ui->cbFunctions->setEnabled(editable);
+	ui->sbA->setEnabled(editable);
+	ui->sbB->setEnabled(editable);
+	ui->sbC->setEnabled(editable);
+	ui->sbFrom->setEnabled(editable);
+	ui->sbTo->setEnabled(editable);
+	ui->sbStep->setEnabled(editable);
+	ui->cbProgressive->setEnabled(isEnable);
+	ui->cbPrecision->setEnabled(editable);
+	ui->sbBudget->setEnabled(isEnable);
 }
 
 void MainWindow::createValueTable() {
@@ -277,6 +646,21 @@ void MainWindow::createValueTable() {
 
 void MainWindow::populateValueTable()
 {
+	// Таблица держит копию ряда в ОЗУ, вытесненный на диск ряд не показывается
+	if( !m_plot.isSeriesResident() )
+		QMessageBox::warning(this, "Value table", tooLargeMessage(), QMessageBox::Ok);
+
 	m_tableWindow->setSeries(m_plot.series());
 	m_tableWindow->setFunctionName(m_plot.functionName());
 }
+
+QString MainWindow::invalidGridMessage() const
+{
+	return QString("The interval is empty or has more than %1 points.").arg(PlotEngine::maxGridSize);
+}
+
+QString MainWindow::tooLargeMessage() const
+{
+	return QString("The series exceeds the memory budget (%1 MB on disk) and cannot be copied.")
+		.arg(m_plot.currentJob()->bytesOnDisk() >> 20);
+}
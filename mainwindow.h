@@ -4,12 +4,16 @@
 #include <QWidget>
 #include <QTimer>
 #include <QPointer>
+#include <QFutureWatcher>
+#include <QHash>
 
 namespace Ui {
     class MainWindow;
 }
 
 class TableWindow;
+class SweepWindow;
+class QProgressDialog;
 
 class MainWindow : public QWidget
 {
@@ -30,6 +34,14 @@ public slots:
 	void setProgress(int);
 	void store();
 	void load();
+	void sweep();
+	void attach();
+	void exportImage();
+	void exportReady();
+	void updateOverlay();
+	void updateEstimate();
+	void scheduleLive();
+	void recomputeLive();
 
 private:
     void setupUi();
@@ -40,14 +52,48 @@ private:
     void populateFunctionComboBox();
 
 	void enableGUI(bool);
+	void setupCalculation();
+	void speculate();
+	// Отмена упреждающих задач и очистка их кэша
+	void dropSpeculative();
+
+	// Все параметры, от которых зависит ряд живого режима
+	struct LiveParams
+	{
+		int fIndex = 0;
+		int A = 0, B = 0, C = 0;
+		double from = 0, to = 0, step = 0;
+		int precision = 0;
+	};
+
+	// Значения, выставленные сейчас в интерфейсе
+	LiveParams liveParams() const;
+	static QString liveKey(const LiveParams &);
 
 	void createValueTable();
 	void populateValueTable();
+	// Отказ для ряда, не помещающегося в ОЗУ, см. Plot::isSeriesResident()
+	QString tooLargeMessage() const;
+	// Отказ для пустой или слишком большой сетки, см. PlotEngine::gridSize()
+	QString invalidGridMessage() const;
 
 private:
     Ui::MainWindow *ui;
     Plot m_plot;
 	QTimer m_refreshTimer; // Обновляет индикатор прогресса и окно графика
 	QPointer<TableWindow> m_tableWindow;
+	QPointer<SweepWindow> m_sweepWindow;
+	QFutureWatcher<QImage> m_overlayWatcher;
+	QFutureWatcher<QString> m_exportWatcher;
+	QPointer<QProgressDialog> m_exportProgress;
+	bool m_attached = false; // Показывается ряд из разделяемой памяти
+
+	/* Живой режим: пересчет через liveDelay мс после последней правки,
+	 * соседние значения A, B, C заранее считаются на свободных ядрах */
+	QTimer m_liveTimer;
+	QHash<QString, PlotJobHandle> m_speculative;
+	LiveParams m_calculated; // Параметры текущей задачи, см. setupCalculation()
+	const int liveDelay = 300;
+	const qint64 speculationLimit = 16 << 20; // Наибольший ряд для упреждающего расчета
 };
 
@@ -1,21 +1,9 @@
-include(lib/plot/plot.pri)
+# Ядро собирается отдельной библиотекой (lib/plot/plotengine.pro),
+# приложение (simple-plot.pro) компонует его, см. plotengine-link.pri
+TEMPLATE = subdirs
 
-VERSION = 1.1
-QT += widgets
+SUBDIRS = plotengine app
 
-CONFIG += c++11
-
-TARGET = simple-plot
-TEMPLATE = app
-
-SOURCES += main.cpp\
-    mainwindow.cpp \
-    tablewindow.cpp
-
-HEADERS  += \
-    mainwindow.h \
-    tablewindow.h
-
-FORMS += \
-    mainwindow.ui \
-    tablewindow.ui
+plotengine.file = lib/plot/plotengine.pro
+app.file = simple-plot.pro
+app.depends = plotengine
@@ -0,0 +1,24 @@
+include(lib/plot/plot.pri)
+
+VERSION = 1.1
+QT += widgets
+
+CONFIG += c++11
+
+TARGET = simple-plot
+TEMPLATE = app
+
+SOURCES += main.cpp\
+    mainwindow.cpp \
+    tablewindow.cpp \
+    sweepwindow.cpp
+
+HEADERS  += \
+    mainwindow.h \
+    tablewindow.h \
+    sweepwindow.h
+
+FORMS += \
+    mainwindow.ui \
+    tablewindow.ui \
+    sweepwindow.ui
@@ -0,0 +1,212 @@
+#include "sweepwindow.h"
+#include "ui_sweepwindow.h"
+#include "lib/plot/plotengine.h"
+#include <QDebug>
+#include <QLabel>
+#include <QPixmap>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <cmath>
+
+SweepWindow::SweepWindow(QWidget *parent)
+	: QWidget(parent)
+	, ui (new Ui::SweepWindow)
+{
+	setupUi();
+	setupTimer();
+	setupConnections();
+
+	setWindowFlags(Qt::Dialog);
+}
+
+void SweepWindow::setFunction(int index, const QString &name)
+{
+	m_fIndex = index;
+	ui->lblFunctionName->setText(QString("f(x) = ") + name);
+}
+
+void SweepWindow::setParams(double A, double B, double C)
+{
+	ui->sbAFrom->setValue(A); ui->sbATo->setValue(A);
+	ui->sbBFrom->setValue(B); ui->sbBTo->setValue(B);
+	ui->sbCFrom->setValue(C); ui->sbCTo->setValue(C);
+}
+
+void SweepWindow::setInterval(double from, double to, double step)
+{
+	m_from = from;
+	m_to = to;
+	m_step = step;
+}
+
+SweepWindow::~SweepWindow()
+{
+	// Экспорт читает перебор и сообщает о ходе в это окно
+	m_sweep.cancelExport();
+	m_exportWatcher.waitForFinished();
+
+	m_sweep.requestInterruption();
+	m_sweep.wait();
+	delete ui;
+}
+
+void SweepWindow::run()
+{
+	if( m_sweep.isRunning() )
+		return;
+
+	const SweepRange A = { ui->sbAFrom->value(), ui->sbATo->value(), ui->sbACount->value() };
+	const SweepRange B = { ui->sbBFrom->value(), ui->sbBTo->value(), ui->sbBCount->value() };
+	const SweepRange C = { ui->sbCFrom->value(), ui->sbCTo->value(), ui->sbCCount->value() };
+	const auto fName = ui->lblFunctionName->text().mid(QString("f(x) = ").length());
+
+	m_sweep.setKernel(PlotFunctions::kernel(m_fIndex), fName);
+	m_sweep.setRanges(A, B, C);
+	m_sweep.setInterval(m_from, m_to, m_step);
+
+	// Счетчики по 1000 значений легко дают миллиарды точек
+	const qint64 gridSize = PlotEngine::gridSize(m_from, m_to, m_step);
+
+	if( gridSize == 0 ) {
+		QMessageBox::warning(this, "Sweep", "The interval is empty or too large.", QMessageBox::Ok);
+		return;
+	}
+
+	if( gridSize > pointLimit / m_sweep.combinations() ) {
+		const qint64 points = gridSize > pointLimit ? gridSize : m_sweep.combinations() * gridSize;
+		QMessageBox::warning(this, "Sweep", QString("The sweep needs %1 points, the limit is %2. "
+			"Reduce the counts or the interval.").arg(points).arg(pointLimit), QMessageBox::Ok);
+		return;
+	}
+
+	if( m_sweep.estimateMemory() > memoryLimit ) {
+		QMessageBox::warning(this, "Sweep", QString("The sweep needs %1 MB of memory, the limit is %2 MB. "
+			"Reduce the counts or the interval.").arg(m_sweep.estimateMemory() >> 20).arg(memoryLimit >> 20),
+			QMessageBox::Ok);
+		return;
+	}
+
+	clearThumbnails();
+	enableGUI(false);
+	ui->progressBar->setValue(0);
+	m_sweep.start();
+	m_refreshTimer.start();
+}
+
+void SweepWindow::interrupt()
+{
+	// Остановленный экспорт завершится через storeReady()
+	if( m_exportWatcher.isRunning() ) {
+		m_sweep.cancelExport();
+		return;
+	}
+
+	m_sweep.requestInterruption();
+	m_sweep.wait();
+	m_refreshTimer.stop();
+	enableGUI(true);
+}
+
+void SweepWindow::runReady()
+{
+	m_refreshTimer.stop();
+	ui->progressBar->setValue(100);
+	populateThumbnails();
+	enableGUI(true);
+}
+
+void SweepWindow::store()
+{
+	const auto results = m_sweep.results();
+
+	if( results.isEmpty() )
+		return;
+
+	const QString dirName = QFileDialog::getExistingDirectory(this, "Export sweep");
+
+	if( dirName.isEmpty() || m_exportWatcher.isRunning() )
+		return;
+
+	// Ряды считаются заново, экспорт идет в рабочем потоке, Break его прерывает
+	enableGUI(false);
+	ui->progressBar->setValue(0);
+
+	m_exportWatcher.setFuture(m_sweep.exportTo(dirName, [this](int percent)
+	{
+		QMetaObject::invokeMethod(this, [this, percent]()
+		{
+			ui->progressBar->setValue(percent);
+		}, Qt::QueuedConnection);
+	}));
+}
+
+void SweepWindow::storeReady()
+{
+	const QString error = m_exportWatcher.result();
+
+	enableGUI(true);
+
+	if( !error.isEmpty() )
+		QMessageBox::warning(this, "Save error", error, QMessageBox::Ok);
+}
+
+/* Private */
+
+void SweepWindow::setupUi()
+{
+	ui->setupUi(this);
+}
+
+void SweepWindow::setupTimer()
+{
+	m_refreshTimer.setParent(this);
+	m_refreshTimer.setInterval(100);
+
+	connect(&m_refreshTimer, &QTimer::timeout, this, [this]()
+	{
+		ui->progressBar->setValue(m_sweep.progress());
+	});
+}
+
+void SweepWindow::setupConnections()
+{
+	connect(ui->btnRun, &QPushButton::clicked, this, &SweepWindow::run);
+	connect(ui->btnBreak, &QPushButton::clicked, this, &SweepWindow::interrupt);
+	connect(ui->btnExport, &QPushButton::clicked, this, &SweepWindow::store);
+	connect(&m_exportWatcher, &QFutureWatcher<QString>::finished, this, &SweepWindow::storeReady);
+	connect(&m_sweep, &PlotSweep::resultReady, this, &SweepWindow::runReady);
+}
+
+void SweepWindow::enableGUI(bool isEnable)
+{
+	ui->sbAFrom->setEnabled(isEnable); ui->sbATo->setEnabled(isEnable); ui->sbACount->setEnabled(isEnable);
+	ui->sbBFrom->setEnabled(isEnable); ui->sbBTo->setEnabled(isEnable); ui->sbBCount->setEnabled(isEnable);
+	ui->sbCFrom->setEnabled(isEnable); ui->sbCTo->setEnabled(isEnable); ui->sbCCount->setEnabled(isEnable);
+	ui->btnRun->setEnabled(isEnable);
+	ui->btnExport->setEnabled(isEnable);
+}
+
+void SweepWindow::populateThumbnails()
+{
+	const auto results = m_sweep.results();
+	const int side = 128;
+	// Квадратная сетка миниатюр
+	const int columns = qMax(1, static_cast<int>( std::ceil(std::sqrt(results.size())) ));
+
+	for(int i = 0; i < results.size(); ++i) {
+		const auto &r = results[i];
+		auto label = new QLabel(ui->thumbnails);
+
+		label->setPixmap(QPixmap::fromImage(PlotEngine::renderImage(r.curve, QSize(side, side))));
+		label->setToolTip(QString("A = %1, B = %2, C = %3").arg(r.A).arg(r.B).arg(r.C));
+		ui->glThumbnails->addWidget(label, i / columns, i % columns);
+	}
+}
+
+void SweepWindow::clearThumbnails()
+{
+	while( auto item = ui->glThumbnails->takeAt(0) ) {
+		delete item->widget();
+		delete item;
+	}
+}
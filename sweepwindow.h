@@ -0,0 +1,53 @@
+#pragma once
+
+#include "lib/plot/plotsweep.h"
+#include <QWidget>
+#include <QTimer>
+#include <QFutureWatcher>
+
+namespace Ui {
+	class SweepWindow;
+}
+
+/* Перебор параметров A, B, C с сеткой миниатюр и пакетным экспортом */
+class SweepWindow: public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit SweepWindow(QWidget * = nullptr);
+
+	void setFunction(int index, const QString &);
+	void setParams(double A, double B, double C);
+	void setInterval(double from, double to, double step);
+
+	~SweepWindow();
+
+public slots:
+	void run();
+	void interrupt();
+	void runReady();
+	void store();
+	void storeReady();
+
+private:
+	void setupUi();
+	void setupTimer();
+	void setupConnections();
+
+	void enableGUI(bool);
+	void populateThumbnails();
+	void clearThumbnails();
+
+private:
+	Ui::SweepWindow *ui;
+	PlotSweep m_sweep;
+	QTimer m_refreshTimer; // Обновляет индикатор прогресса
+	QFutureWatcher<QString> m_exportWatcher;
+	int m_fIndex = 0;
+	double m_from = 0, m_to = 0, m_step = 0;
+
+	/* Ограничения перебора: всего вычисляемых точек и памяти на него */
+	const qint64 pointLimit = Q_INT64_C(1) << 32;
+	const qint64 memoryLimit = Q_INT64_C(1) << 30;
+};